@@ -1,5 +1,9 @@
 
 #include <asset_loader.h>
+#include <lz4.h>
+#include <lz4hc.h>
+#include "Tracy.hpp"
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -36,6 +40,8 @@ bool assets::save_binaryfile(const char *path, const AssetFile &file) {
 }
 
 bool assets::load_binaryfile(const char *path, AssetFile &outputFile) {
+    ZoneScopedN("Load Binary File")
+
     std::ifstream infile;
     infile.open(path, std::ios::binary);
 
@@ -72,3 +78,49 @@ assets::CompressionMode assets::parse_compression(const char *f) {
     }
 }
 
+
+assets::CompressionCodec assets::parse_codec(const char *f) {
+    if (strcmp(f, "lz4") == 0 || strcmp(f, "LZ4") == 0) {
+        return assets::CompressionCodec::LZ4;
+    } else if (strcmp(f, "lz4hc") == 0 || strcmp(f, "LZ4HC") == 0) {
+        return assets::CompressionCodec::LZ4HC;
+    } else {
+        return assets::CompressionCodec::None;
+    }
+}
+
+size_t assets::compress_block(const CompressionSettings &settings, const char *source, size_t sourceSize,
+                              std::vector<char> &destination) {
+    ZoneScopedN("Compress Block")
+
+    size_t offset = destination.size();
+
+    int compressedSize = 0;
+    if (settings.codec != CompressionCodec::None && sourceSize > 0) {
+        //compress straight into the tail of the destination, no staging buffer
+        int bound = LZ4_compressBound(static_cast<int>(sourceSize));
+        destination.resize(offset + bound);
+
+        if (settings.codec == CompressionCodec::LZ4HC) {
+            int level = settings.level > 0 ? std::min(settings.level, LZ4HC_CLEVEL_MAX) : LZ4HC_CLEVEL_DEFAULT;
+            compressedSize = LZ4_compress_HC(source, destination.data() + offset, static_cast<int>(sourceSize),
+                                             bound, level);
+        } else {
+            int acceleration = std::max(settings.level, 1);
+            compressedSize = LZ4_compress_fast(source, destination.data() + offset, static_cast<int>(sourceSize),
+                                               bound, acceleration);
+        }
+    }
+
+    //a block that didn't shrink enough is stored raw. Anything not strictly smaller is always raw,
+    //so loaders can tell raw blocks apart by compressedSize == originalSize
+    float ratio = sourceSize > 0 ? float(compressedSize) / float(sourceSize) : 1.0f;
+    if (compressedSize <= 0 || size_t(compressedSize) >= sourceSize || ratio > settings.maxRatio) {
+        destination.resize(offset + sourceSize);
+        memcpy(destination.data() + offset, source, sourceSize);
+        return sourceSize;
+    }
+
+    destination.resize(offset + compressedSize);
+    return compressedSize;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -16,9 +17,34 @@ namespace assets {
         LZ4
     };
 
+    //encoder picked at bake time. LZ4 and LZ4HC write the same block format, so loading doesn't care which was used
+    enum class CompressionCodec : uint32_t {
+        None,
+        LZ4,
+        LZ4HC
+    };
+
+    struct CompressionSettings {
+        CompressionCodec codec{CompressionCodec::LZ4};
+
+        //0 picks the codec default. For LZ4 this is the acceleration (higher is faster with a worse ratio),
+        //for LZ4HC the level from 1 to 12 (higher is slower to bake, decompression speed stays the same)
+        int level{0};
+
+        //a block only stays compressed if compressedSize / originalSize is at or below this
+        float maxRatio{0.8f};
+    };
+
+    //appends source to destination, compressed if that is worth it under the settings, raw otherwise.
+    //returns the bytes appended, which equals sourceSize exactly when the block was stored raw
+    size_t compress_block(const CompressionSettings &settings, const char *source, size_t sourceSize,
+                          std::vector<char> &destination);
+
     bool save_binaryfile(const char *path, const AssetFile &file);
 
     bool load_binaryfile(const char *path, AssetFile &outputFile);
 
     assets::CompressionMode parse_compression(const char *f);
+
+    assets::CompressionCodec parse_codec(const char *f);
 }
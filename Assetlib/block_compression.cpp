@@ -0,0 +1,456 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "block_compression.h"
+#include "Tracy.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+    //principal axis of the points through power iteration on the covariance matrix.
+    //works on the first `dims` channels, so the same code fits RGB, RGBA and single channel blocks
+    void principal_axis(const float (*points)[4], int count, int dims, float mean[4], float axis[4]) {
+        for (int c = 0; c < 4; c++) {
+            mean[c] = 0.0f;
+            axis[c] = 0.0f;
+        }
+        for (int i = 0; i < count; i++) {
+            for (int c = 0; c < dims; c++) {
+                mean[c] += points[i][c];
+            }
+        }
+        for (int c = 0; c < dims; c++) {
+            mean[c] /= float(count);
+        }
+
+        float covariance[4][4] = {};
+        for (int i = 0; i < count; i++) {
+            float d[4] = {};
+            for (int c = 0; c < dims; c++) {
+                d[c] = points[i][c] - mean[c];
+            }
+            for (int r = 0; r < dims; r++) {
+                for (int c = 0; c < dims; c++) {
+                    covariance[r][c] += d[r] * d[c];
+                }
+            }
+        }
+
+        //start along the luminance-ish diagonal, a few iterations are plenty for 16 points
+        for (int c = 0; c < dims; c++) {
+            axis[c] = 1.0f;
+        }
+        for (int iteration = 0; iteration < 8; iteration++) {
+            float next[4] = {};
+            for (int r = 0; r < dims; r++) {
+                for (int c = 0; c < dims; c++) {
+                    next[r] += covariance[r][c] * axis[c];
+                }
+            }
+
+            float length = 0.0f;
+            for (int c = 0; c < dims; c++) {
+                length = std::max(length, std::abs(next[c]));
+            }
+            if (length < 1e-6f) {
+                break;
+            }
+            for (int c = 0; c < dims; c++) {
+                axis[c] = next[c] / length;
+            }
+        }
+    }
+
+    //endpoints a and b for a palette of `levels` evenly spaced entries between them.
+    //starts from the extremes along the principal axis, then one least squares pass with the points snapped to levels
+    void fit_endpoints(const float (*points)[4], int count, int dims, int levels, float a[4], float b[4]) {
+        float mean[4];
+        float axis[4];
+        principal_axis(points, count, dims, mean, axis);
+
+        float minT = 0.0f;
+        float maxT = 0.0f;
+        for (int i = 0; i < count; i++) {
+            float t = 0.0f;
+            for (int c = 0; c < dims; c++) {
+                t += (points[i][c] - mean[c]) * axis[c];
+            }
+            if (i == 0 || t < minT) minT = t;
+            if (i == 0 || t > maxT) maxT = t;
+        }
+
+        float axisLength2 = 0.0f;
+        for (int c = 0; c < dims; c++) {
+            axisLength2 += axis[c] * axis[c];
+        }
+        if (axisLength2 > 0.0f) {
+            minT /= axisLength2;
+            maxT /= axisLength2;
+        }
+
+        for (int c = 0; c < 4; c++) {
+            a[c] = c < dims ? mean[c] + axis[c] * minT : 0.0f;
+            b[c] = c < dims ? mean[c] + axis[c] * maxT : 0.0f;
+        }
+
+        float ab[4] = {};
+        float ab2 = 0.0f;
+        for (int c = 0; c < dims; c++) {
+            ab[c] = b[c] - a[c];
+            ab2 += ab[c] * ab[c];
+        }
+        if (ab2 < 1e-6f) {
+            return;
+        }
+
+        //minimise sum |(1-t)a + t b - x|^2 with t fixed at the snapped palette positions
+        float alpha2 = 0.0f, beta2 = 0.0f, alphaBeta = 0.0f;
+        float alphaX[4] = {}, betaX[4] = {};
+        for (int i = 0; i < count; i++) {
+            float t = 0.0f;
+            for (int c = 0; c < dims; c++) {
+                t += (points[i][c] - a[c]) * ab[c];
+            }
+            t = std::clamp(t / ab2, 0.0f, 1.0f);
+            t = std::round(t * float(levels - 1)) / float(levels - 1);
+
+            float s = 1.0f - t;
+            alpha2 += s * s;
+            beta2 += t * t;
+            alphaBeta += s * t;
+            for (int c = 0; c < dims; c++) {
+                alphaX[c] += s * points[i][c];
+                betaX[c] += t * points[i][c];
+            }
+        }
+
+        float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+        if (std::abs(determinant) < 1e-6f) {
+            return;
+        }
+
+        for (int c = 0; c < dims; c++) {
+            a[c] = std::clamp((beta2 * alphaX[c] - alphaBeta * betaX[c]) / determinant, 0.0f, 255.0f);
+            b[c] = std::clamp((alpha2 * betaX[c] - alphaBeta * alphaX[c]) / determinant, 0.0f, 255.0f);
+        }
+    }
+
+    uint16_t pack_565(const float color[4]) {
+        int r = std::clamp(int(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+        int g = std::clamp(int(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+        int b = std::clamp(int(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+        return uint16_t((r << 11) | (g << 5) | b);
+    }
+
+    void unpack_565(uint16_t packed, int color[3]) {
+        int r = (packed >> 11) & 31;
+        int g = (packed >> 5) & 63;
+        int b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    //the 8 byte colour half of BC1/BC3. BC1 may use the 3 colour + transparent mode for cut-out alpha,
+    //BC3 always decodes in 4 colour mode
+    void encode_color_block(const uint8_t *pixels, uint8_t *output, bool allowTransparent) {
+        float points[16][4];
+        bool transparent[16];
+        int count = 0;
+        bool anyTransparent = false;
+
+        for (int i = 0; i < 16; i++) {
+            transparent[i] = allowTransparent && pixels[i * 4 + 3] < 128;
+            anyTransparent |= transparent[i];
+            if (!transparent[i]) {
+                points[count][0] = pixels[i * 4 + 0];
+                points[count][1] = pixels[i * 4 + 1];
+                points[count][2] = pixels[i * 4 + 2];
+                points[count][3] = 0.0f;
+                count++;
+            }
+        }
+
+        uint16_t c0 = 0;
+        uint16_t c1 = 0;
+        if (count > 0) {
+            float a[4];
+            float b[4];
+            fit_endpoints(points, count, 3, anyTransparent ? 3 : 4, a, b);
+            c0 = pack_565(a);
+            c1 = pack_565(b);
+        }
+
+        //4 colour mode needs c0 > c1, the transparent mode needs c0 <= c1
+        if ((!anyTransparent && c0 < c1) || (anyTransparent && c0 > c1)) {
+            std::swap(c0, c1);
+        }
+
+        int palette[4][3];
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        int paletteSize;
+        if (c0 > c1) {
+            for (int c = 0; c < 3; c++) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+            }
+            paletteSize = 4;
+        } else {
+            for (int c = 0; c < 3; c++) {
+                palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+            }
+            paletteSize = 3;
+        }
+
+        uint32_t indices = 0;
+        for (int i = 0; i < 16; i++) {
+            uint32_t best = 3;
+            if (!transparent[i]) {
+                int bestError = INT32_MAX;
+                for (int p = 0; p < paletteSize; p++) {
+                    int error = 0;
+                    for (int c = 0; c < 3; c++) {
+                        int d = int(pixels[i * 4 + c]) - palette[p][c];
+                        error += d * d;
+                    }
+                    if (error < bestError) {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+            }
+            indices |= best << (i * 2);
+        }
+
+        output[0] = uint8_t(c0 & 0xFF);
+        output[1] = uint8_t(c0 >> 8);
+        output[2] = uint8_t(c1 & 0xFF);
+        output[3] = uint8_t(c1 >> 8);
+        memcpy(output + 4, &indices, 4);
+    }
+
+    //8 byte single channel block, the alpha half of BC3 and both halves of BC5
+    void encode_channel_block(const uint8_t *pixels, int channel, uint8_t *output) {
+        float points[16][4] = {};
+        for (int i = 0; i < 16; i++) {
+            points[i][0] = pixels[i * 4 + channel];
+        }
+
+        float a[4];
+        float b[4];
+        fit_endpoints(points, 16, 1, 8, a, b);
+
+        //8 value mode needs a0 > a1, equal endpoints decode index 0 as a0 either way
+        int a0 = std::clamp(int(std::round(std::max(a[0], b[0]))), 0, 255);
+        int a1 = std::clamp(int(std::round(std::min(a[0], b[0]))), 0, 255);
+
+        int palette[8];
+        palette[0] = a0;
+        palette[1] = a1;
+        for (int k = 1; k < 7; k++) {
+            palette[k + 1] = ((7 - k) * a0 + k * a1 + 3) / 7;
+        }
+
+        uint64_t indices = 0;
+        for (int i = 0; i < 16; i++) {
+            int value = pixels[i * 4 + channel];
+            uint64_t best = 0;
+            int bestError = INT32_MAX;
+            for (int p = 0; p < 8; p++) {
+                int error = std::abs(value - palette[p]);
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 3);
+        }
+
+        output[0] = uint8_t(a0);
+        output[1] = uint8_t(a1);
+        for (int i = 0; i < 6; i++) {
+            output[2 + i] = uint8_t(indices >> (i * 8));
+        }
+    }
+
+    void write_bits(uint8_t *output, uint32_t &position, uint32_t value, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++, position++) {
+            if (value & (1u << i)) {
+                output[position / 8] |= uint8_t(1u << (position % 8));
+            }
+        }
+    }
+
+    //7 bit endpoint + shared p-bit, picks the p-bit that lands closer to the unquantized value
+    void quantize_bc7_endpoint(const float endpoint[4], int quantized[4], int &pbit) {
+        int bestError = INT32_MAX;
+        for (int p = 0; p < 2; p++) {
+            int candidate[4];
+            int error = 0;
+            for (int c = 0; c < 4; c++) {
+                candidate[c] = std::clamp(int(std::round((endpoint[c] - float(p)) / 2.0f)), 0, 127);
+                int d = ((candidate[c] << 1) | p) - int(std::round(endpoint[c]));
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                pbit = p;
+                memcpy(quantized, candidate, sizeof(candidate));
+            }
+        }
+    }
+}
+
+void assets::encode_bc1_block(const uint8_t *pixels, uint8_t *output) {
+    encode_color_block(pixels, output, true);
+}
+
+void assets::encode_bc3_block(const uint8_t *pixels, uint8_t *output) {
+    encode_channel_block(pixels, 3, output);
+    encode_color_block(pixels, output + 8, false);
+}
+
+void assets::encode_bc5_block(const uint8_t *pixels, uint8_t *output) {
+    encode_channel_block(pixels, 0, output);
+    encode_channel_block(pixels, 1, output + 8);
+}
+
+//BC7 mode 6 only: one subset, RGBA 7 bit endpoints with a p-bit each and 4 bit indices.
+//it is the single mode that handles every kind of block reasonably, the multi-subset modes are left out
+void assets::encode_bc7_block(const uint8_t *pixels, uint8_t *output) {
+    static const int weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    float points[16][4];
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            points[i][c] = pixels[i * 4 + c];
+        }
+    }
+
+    float a[4];
+    float b[4];
+    fit_endpoints(points, 16, 4, 16, a, b);
+
+    int endpoints[2][4];
+    int pbits[2];
+    quantize_bc7_endpoint(a, endpoints[0], pbits[0]);
+    quantize_bc7_endpoint(b, endpoints[1], pbits[1]);
+
+    int palette[16][4];
+    for (int c = 0; c < 4; c++) {
+        int e0 = (endpoints[0][c] << 1) | pbits[0];
+        int e1 = (endpoints[1][c] << 1) | pbits[1];
+        for (int k = 0; k < 16; k++) {
+            palette[k][c] = ((64 - weights[k]) * e0 + weights[k] * e1 + 32) >> 6;
+        }
+    }
+
+    int indices[16];
+    for (int i = 0; i < 16; i++) {
+        int bestError = INT32_MAX;
+        for (int k = 0; k < 16; k++) {
+            int error = 0;
+            for (int c = 0; c < 4; c++) {
+                int d = int(pixels[i * 4 + c]) - palette[k][c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                indices[i] = k;
+            }
+        }
+    }
+
+    //the first index is stored with 3 bits, so its top bit has to be 0. Swapping the endpoints flips every index
+    if (indices[0] & 8) {
+        std::swap(endpoints[0], endpoints[1]);
+        std::swap(pbits[0], pbits[1]);
+        for (int &index: indices) {
+            index = 15 - index;
+        }
+    }
+
+    memset(output, 0, 16);
+    uint32_t position = 0;
+    write_bits(output, position, 1u << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        write_bits(output, position, endpoints[0][c], 7);
+        write_bits(output, position, endpoints[1][c], 7);
+    }
+    write_bits(output, position, pbits[0], 1);
+    write_bits(output, position, pbits[1], 1);
+    write_bits(output, position, indices[0], 3);
+    for (int i = 1; i < 16; i++) {
+        write_bits(output, position, indices[i], 4);
+    }
+}
+
+std::vector<char> assets::encode_blocks(TextureFormat format, const uint8_t *rgba, uint32_t width, uint32_t height,
+                                        uint32_t threadCount) {
+    ZoneScopedN("Encode Blocks")
+
+    void (*encodeBlock)(const uint8_t *, uint8_t *);
+    switch (format) {
+        case TextureFormat::BC1:
+            encodeBlock = encode_bc1_block;
+            break;
+        case TextureFormat::BC3:
+            encodeBlock = encode_bc3_block;
+            break;
+        case TextureFormat::BC5:
+            encodeBlock = encode_bc5_block;
+            break;
+        case TextureFormat::BC7:
+            encodeBlock = encode_bc7_block;
+            break;
+        default:
+            return {};
+    }
+
+    uint32_t blockBytes = texture_block_size(format);
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+
+    std::vector<char> output(size_t(blocksX) * blocksY * blockBytes);
+
+    //workers pull rows of blocks until there are none left, rows are cheap enough that the atomic isn't contended
+    std::atomic<uint32_t> nextRow{0};
+    auto worker = [&]() {
+        uint8_t block[64];
+        for (uint32_t by = nextRow.fetch_add(1); by < blocksY; by = nextRow.fetch_add(1)) {
+            for (uint32_t bx = 0; bx < blocksX; bx++) {
+                for (uint32_t y = 0; y < 4; y++) {
+                    uint32_t sourceY = std::min(by * 4 + y, height - 1);
+                    for (uint32_t x = 0; x < 4; x++) {
+                        uint32_t sourceX = std::min(bx * 4 + x, width - 1);
+                        memcpy(block + (y * 4 + x) * 4, rgba + (size_t(sourceY) * width + sourceX) * 4, 4);
+                    }
+                }
+                encodeBlock(block, (uint8_t *) output.data() + (size_t(by) * blocksX + bx) * blockBytes);
+            }
+        }
+    };
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, blocksY);
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < threadCount; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+
+    return output;
+}
@@ -0,0 +1,28 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include "texture_asset.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace assets {
+
+    //encodes an RGBA8 image into GPU block compressed data for format (BC1, BC3, BC5 or BC7).
+    //the image is split into rows of 4x4 blocks that are handed out to threadCount workers, 0 uses every core.
+    //edge blocks of sizes that aren't a multiple of 4 repeat the last row/column
+    std::vector<char> encode_blocks(TextureFormat format, const uint8_t *rgba, uint32_t width, uint32_t height,
+                                    uint32_t threadCount = 0);
+
+    //single block encoders, pixels is 16 RGBA8 texels in row order
+    void encode_bc1_block(const uint8_t *pixels, uint8_t *output);
+
+    void encode_bc3_block(const uint8_t *pixels, uint8_t *output);
+
+    void encode_bc5_block(const uint8_t *pixels, uint8_t *output);
+
+    void encode_bc7_block(const uint8_t *pixels, uint8_t *output);
+}
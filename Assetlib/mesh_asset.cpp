@@ -1,6 +1,7 @@
 #include "mesh_asset.h"
 #include "json.hpp"
 #include "lz4.h"
+#include "Tracy.hpp"
 #include <cstring>
 
 inline assets::VertexFormat parse_format(const char *f) {
@@ -49,6 +50,15 @@ assets::MeshInfo assets::read_mesh_info(AssetFile *file) {
 
 void
 assets::unpack_mesh(MeshInfo *info, const char *sourcebuffer, size_t sourceSize, char *vertexBufer, char *indexBuffer) {
+    ZoneScopedNC("Decompress Mesh", tracy::Color::Magenta)
+
+    //meshes that didn't compress well are stored raw, copy them straight out
+    if (info->compressionMode == CompressionMode::None) {
+        memcpy(vertexBufer, sourcebuffer, info->vertexBuferSize);
+        memcpy(indexBuffer, sourcebuffer + info->vertexBuferSize, info->indexBuferSize);
+        return;
+    }
+
     //decompressing into temporal vector. TODO: streaming decompress directly on the buffers
     std::vector<char> decompressedBuffer;
     decompressedBuffer.resize(info->vertexBuferSize + info->indexBuferSize);
@@ -63,7 +73,8 @@ assets::unpack_mesh(MeshInfo *info, const char *sourcebuffer, size_t sourceSize,
     memcpy(indexBuffer, decompressedBuffer.data() + info->vertexBuferSize, info->indexBuferSize);
 }
 
-assets::AssetFile assets::pack_mesh(MeshInfo *info, char *vertexData, char *indexData) {
+assets::AssetFile assets::pack_mesh(MeshInfo *info, char *vertexData, char *indexData,
+                                    const CompressionSettings &compression) {
     AssetFile file;
     file.type[0] = 'M';
     file.type[1] = 'E';
@@ -109,17 +120,11 @@ assets::AssetFile assets::pack_mesh(MeshInfo *info, char *vertexData, char *inde
     memcpy(merged_buffer.data() + info->vertexBuferSize, indexData, info->indexBuferSize);
 
 
-    //compress buffer and copy it into the file struct
-    size_t compressStaging = LZ4_compressBound(static_cast<int>(fullsize));
-
-    file.binaryBlob.resize(compressStaging);
-
-    int compressedSize = LZ4_compress_default(merged_buffer.data(), file.binaryBlob.data(),
-                                              static_cast<int>(merged_buffer.size()),
-                                              static_cast<int>(compressStaging));
-    file.binaryBlob.resize(compressedSize);
+    //compress buffer into the file struct, or keep it raw if the ratio isn't worth the decompress
+    size_t compressedSize = compress_block(compression, merged_buffer.data(), merged_buffer.size(), file.binaryBlob);
 
-    metadata["compression"] = "LZ4";
+    info->compressionMode = compressedSize == fullsize ? CompressionMode::None : CompressionMode::LZ4;
+    metadata["compression"] = info->compressionMode == CompressionMode::LZ4 ? "LZ4" : "None";
 
     file.json = metadata.dump();
 
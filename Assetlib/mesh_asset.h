@@ -49,7 +49,7 @@ namespace assets {
 
     void unpack_mesh(MeshInfo *info, const char *sourcebuffer, size_t sourceSize, char *vertexBufer, char *indexBuffer);
 
-    AssetFile pack_mesh(MeshInfo *info, char *vertexData, char *indexData);
+    AssetFile pack_mesh(MeshInfo *info, char *vertexData, char *indexData, const CompressionSettings &compression = {});
 
     MeshBounds calculateBounds(Vertex_f32_PNCV *vertices, size_t count);
 }
\ No newline at end of file
@@ -0,0 +1,151 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "mip_generation.h"
+#include "Tracy.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    const float pi = 3.14159265358979f;
+
+    float srgb_to_linear(float value) {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float linear_to_srgb(float value) {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    //zeroth order modified bessel function, for the kaiser window
+    float bessel_i0(float x) {
+        float sum = 1.0f;
+        float term = 1.0f;
+        for (int k = 1; k < 16; k++) {
+            term *= (x / (2.0f * float(k))) * (x / (2.0f * float(k)));
+            sum += term;
+        }
+        return sum;
+    }
+
+    //taps for a 2:1 reduction. The destination texel sits between source texels 2x and 2x+1,
+    //tap i covers source texel 2x - taps/2 + 1 + i
+    std::vector<float> make_kernel(assets::MipFilter filter) {
+        if (filter == assets::MipFilter::Box) {
+            return {0.5f, 0.5f};
+        }
+
+        const int taps = 8;
+        const float alpha = 4.0f;
+        const float radius = 2.0f; //in destination texels
+
+        std::vector<float> kernel(taps);
+        float sum = 0.0f;
+        for (int i = 0; i < taps; i++) {
+            //distance from the destination texel centre, in destination texels
+            float t = (float(i - taps / 2) + 0.5f) / 2.0f;
+
+            float sinc = std::abs(t) < 1e-5f ? 1.0f : std::sin(pi * t) / (pi * t);
+            float window = bessel_i0(alpha * std::sqrt(std::max(0.0f, 1.0f - (t / radius) * (t / radius)))) /
+                           bessel_i0(alpha);
+
+            kernel[i] = sinc * window;
+            sum += kernel[i];
+        }
+        for (float &weight: kernel) {
+            weight /= sum;
+        }
+        return kernel;
+    }
+
+    //halves one axis of a float RGBA image, an axis already at 1 is left alone
+    std::vector<float> downsample_axis(const std::vector<float> &source, uint32_t width, uint32_t height,
+                                       bool horizontal, const std::vector<float> &kernel) {
+        uint32_t sourceLength = horizontal ? width : height;
+        if (sourceLength == 1) {
+            return source;
+        }
+
+        uint32_t targetLength = sourceLength / 2;
+        uint32_t targetWidth = horizontal ? targetLength : width;
+        uint32_t targetHeight = horizontal ? height : targetLength;
+
+        std::vector<float> target(size_t(targetWidth) * targetHeight * 4);
+        int firstTap = 1 - int(kernel.size()) / 2;
+
+        for (uint32_t y = 0; y < targetHeight; y++) {
+            for (uint32_t x = 0; x < targetWidth; x++) {
+                float sum[4] = {};
+                uint32_t along = horizontal ? x : y;
+
+                for (size_t tap = 0; tap < kernel.size(); tap++) {
+                    //clamp to edge
+                    int sample = std::clamp(int(along) * 2 + firstTap + int(tap), 0, int(sourceLength) - 1);
+                    uint32_t sx = horizontal ? uint32_t(sample) : x;
+                    uint32_t sy = horizontal ? y : uint32_t(sample);
+
+                    const float *texel = &source[(size_t(sy) * width + sx) * 4];
+                    for (int c = 0; c < 4; c++) {
+                        sum[c] += texel[c] * kernel[tap];
+                    }
+                }
+
+                float *out = &target[(size_t(y) * targetWidth + x) * 4];
+                for (int c = 0; c < 4; c++) {
+                    //the sinc lobes can overshoot
+                    out[c] = std::clamp(sum[c], 0.0f, 1.0f);
+                }
+            }
+        }
+
+        return target;
+    }
+}
+
+std::vector<assets::MipLevel>
+assets::generate_mips(const uint8_t *rgba, uint32_t width, uint32_t height, MipFilter filter, bool srgb) {
+    ZoneScopedN("Generate Mips")
+
+    //8 bit to linear lookup, the colour channels go through it once on the way in
+    float toLinear[256];
+    for (int i = 0; i < 256; i++) {
+        toLinear[i] = srgb ? srgb_to_linear(float(i) / 255.0f) : float(i) / 255.0f;
+    }
+
+    std::vector<MipLevel> levels;
+    levels.push_back({width, height, std::vector<uint8_t>(rgba, rgba + size_t(width) * height * 4)});
+
+    std::vector<float> current(size_t(width) * height * 4);
+    for (size_t i = 0; i < size_t(width) * height; i++) {
+        current[i * 4 + 0] = toLinear[rgba[i * 4 + 0]];
+        current[i * 4 + 1] = toLinear[rgba[i * 4 + 1]];
+        current[i * 4 + 2] = toLinear[rgba[i * 4 + 2]];
+        current[i * 4 + 3] = float(rgba[i * 4 + 3]) / 255.0f;
+    }
+
+    std::vector<float> kernel = make_kernel(filter);
+
+    while (width > 1 || height > 1) {
+        current = downsample_axis(current, width, height, true, kernel);
+        width = std::max(1u, width / 2);
+        current = downsample_axis(current, width, height, false, kernel);
+        height = std::max(1u, height / 2);
+
+        MipLevel level{width, height, std::vector<uint8_t>(size_t(width) * height * 4)};
+        for (size_t i = 0; i < size_t(width) * height; i++) {
+            for (int c = 0; c < 4; c++) {
+                float value = current[i * 4 + c];
+                if (srgb && c < 3) {
+                    value = linear_to_srgb(value);
+                }
+                level.pixels[i * 4 + c] = uint8_t(std::clamp(value * 255.0f + 0.5f, 0.0f, 255.0f));
+            }
+        }
+        levels.push_back(std::move(level));
+    }
+
+    return levels;
+}
@@ -0,0 +1,28 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace assets {
+
+    enum class MipFilter : uint32_t {
+        Box,   //2x2 average, fast but soft and a little aliased
+        Kaiser //windowed sinc over 8 taps, keeps distant detail sharper
+    };
+
+    struct MipLevel {
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint8_t> pixels; //RGBA8
+    };
+
+    //builds the full chain down to 1x1 from an RGBA8 image, level 0 is a copy of the input.
+    //with srgb the colour channels are filtered in linear space and converted back, alpha is always linear.
+    //every level is filtered from the float result of the previous one so rounding doesn't build up
+    std::vector<MipLevel> generate_mips(const uint8_t *rgba, uint32_t width, uint32_t height, MipFilter filter,
+                                        bool srgb);
+}
@@ -1,17 +1,71 @@
 #include <texture_asset.h>
 #include <json.hpp>
 #include <lz4.h>
+#include "Tracy.hpp"
 #include <iostream>
+#include <cstring>
 
 inline assets::TextureFormat parse_format(const char *f) {
 
     if (strcmp(f, "RGBA8") == 0) {
         return assets::TextureFormat::RGBA8;
+    } else if (strcmp(f, "BC1") == 0) {
+        return assets::TextureFormat::BC1;
+    } else if (strcmp(f, "BC3") == 0) {
+        return assets::TextureFormat::BC3;
+    } else if (strcmp(f, "BC5") == 0) {
+        return assets::TextureFormat::BC5;
+    } else if (strcmp(f, "BC7") == 0) {
+        return assets::TextureFormat::BC7;
     } else {
         return assets::TextureFormat::Unknown;
     }
 }
 
+inline const char *format_name(assets::TextureFormat format) {
+    switch (format) {
+        case assets::TextureFormat::RGBA8:
+            return "RGBA8";
+        case assets::TextureFormat::BC1:
+            return "BC1";
+        case assets::TextureFormat::BC3:
+            return "BC3";
+        case assets::TextureFormat::BC5:
+            return "BC5";
+        case assets::TextureFormat::BC7:
+            return "BC7";
+        default:
+            return "Unknown";
+    }
+}
+
+uint32_t assets::texture_block_size(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::RGBA8:
+            return 4;
+        case TextureFormat::BC1:
+            return 8;
+        case TextureFormat::BC3:
+        case TextureFormat::BC5:
+        case TextureFormat::BC7:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+bool assets::is_block_compressed(TextureFormat format) {
+    return format == TextureFormat::BC1 || format == TextureFormat::BC3 || format == TextureFormat::BC5 ||
+           format == TextureFormat::BC7;
+}
+
+uint32_t assets::texture_page_size(TextureFormat format, uint32_t width, uint32_t height) {
+    if (is_block_compressed(format)) {
+        return ((width + 3) / 4) * ((height + 3) / 4) * texture_block_size(format);
+    }
+    return width * height * texture_block_size(format);
+}
+
 assets::TextureInfo assets::read_texture_info(AssetFile *file) {
     TextureInfo info;
 
@@ -23,6 +77,9 @@ assets::TextureInfo assets::read_texture_info(AssetFile *file) {
     std::string compressionString = texture_metadata["compression"];
     info.compressionMode = parse_compression(compressionString.c_str());
 
+    //files baked before the colour space was stored are all sRGB colour textures
+    info.srgb = texture_metadata.value("srgb", true);
+
     info.textureSize = texture_metadata["buffer_size"];
     info.originalFile = texture_metadata["original_file"];
 
@@ -42,11 +99,18 @@ assets::TextureInfo assets::read_texture_info(AssetFile *file) {
 }
 
 void assets::unpack_texture(TextureInfo *info, const char *sourcebuffer, size_t sourceSize, char *destination) {
+    ZoneScopedNC("Decompress Texture", tracy::Color::Magenta)
+
     if (info->compressionMode == CompressionMode::LZ4) {
 
 
         for (auto &page: info->pages) {
-            LZ4_decompress_safe(sourcebuffer, destination, page.compressedSize, page.originalSize);
+            //pages that didn't compress well are stored raw, same rule as unpack_texture_page
+            if (page.compressedSize != page.originalSize) {
+                LZ4_decompress_safe(sourcebuffer, destination, page.compressedSize, page.originalSize);
+            } else {
+                memcpy(destination, sourcebuffer, page.originalSize);
+            }
             sourcebuffer += page.compressedSize;
             destination += page.originalSize;
         }
@@ -57,6 +121,8 @@ void assets::unpack_texture(TextureInfo *info, const char *sourcebuffer, size_t
 }
 
 void assets::unpack_texture_page(TextureInfo *info, int pageIndex, char *sourcebuffer, char *destination) {
+    ZoneScopedNC("Decompress Texture Page", tracy::Color::Magenta)
+
     char *source = sourcebuffer;
     for (int i = 0; i < pageIndex; i++) {
         source += info->pages[i].compressedSize;
@@ -80,7 +146,7 @@ void assets::unpack_texture_page(TextureInfo *info, int pageIndex, char *sourceb
 }
 
 
-assets::AssetFile assets::pack_texture(TextureInfo *info, void *pixelData) {
+assets::AssetFile assets::pack_texture(TextureInfo *info, void *pixelData, const CompressionSettings &compression) {
     //core file header
     AssetFile file;
     file.type[0] = 'T';
@@ -90,44 +156,25 @@ assets::AssetFile assets::pack_texture(TextureInfo *info, void *pixelData) {
     file.version = 1;
 
 
+    //each page is compressed on its own, and kept raw if it doesn't compress well against its own size
+    bool anyCompressed = false;
     char *pixels = (char *) pixelData;
-    std::vector<char> page_buffer;
     for (auto &p: info->pages) {
-        page_buffer.resize(p.originalSize);
-
-
-        //compress buffer into blob
-        int compressStaging = LZ4_compressBound(p.originalSize);
-
-        page_buffer.resize(compressStaging);
-
-        int compressedSize = LZ4_compress_default(pixels, page_buffer.data(), p.originalSize, compressStaging);
-
-
-        float compression_rate = float(compressedSize) / float(info->textureSize);
-
-        //if the compression is more than 80% of the original size, its not worth to use it
-        if (compression_rate > 0.8) {
-            compressedSize = p.originalSize;
-            page_buffer.resize(compressedSize);
-
-            memcpy(page_buffer.data(), pixels, compressedSize);
-        } else {
-            page_buffer.resize(compressedSize);
-        }
-        p.compressedSize = compressedSize;
-
-        file.binaryBlob.insert(file.binaryBlob.end(), page_buffer.begin(), page_buffer.end());
+        p.compressedSize = static_cast<uint32_t>(compress_block(compression, pixels, p.originalSize, file.binaryBlob));
+        anyCompressed |= p.compressedSize != p.originalSize;
 
         //advance pixel pointer to next page
         pixels += p.originalSize;
     }
+    info->compressionMode = anyCompressed ? CompressionMode::LZ4 : CompressionMode::None;
+
     nlohmann::json texture_metadata;
-    texture_metadata["format"] = "RGBA8";
+    texture_metadata["format"] = format_name(info->textureFormat);
+    texture_metadata["srgb"] = info->srgb;
 
     texture_metadata["buffer_size"] = info->textureSize;
     texture_metadata["original_file"] = info->originalFile;
-    texture_metadata["compression"] = "LZ4";
+    texture_metadata["compression"] = anyCompressed ? "LZ4" : "None";
 
     std::vector<nlohmann::json> page_json;
     for (auto &p: info->pages) {
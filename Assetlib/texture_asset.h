@@ -6,7 +6,12 @@ namespace assets {
 
     enum class TextureFormat : uint32_t {
         Unknown = 0,
-        RGBA8
+        RGBA8,
+        //GPU block compressed, 4x4 texels per block
+        BC1, //RGB + 1 bit alpha, 8 bytes per block
+        BC3, //RGBA, 16 bytes per block
+        BC5, //two channels (normal maps), 16 bytes per block
+        BC7  //RGBA at higher quality than BC3, 16 bytes per block
     };
 
     struct PageInfo {
@@ -20,6 +25,8 @@ namespace assets {
         uint64_t textureSize;
         TextureFormat textureFormat;
         CompressionMode compressionMode;
+        //colour data is sampled through an sRGB view, normal maps and masks are linear
+        bool srgb{true};
 
         std::string originalFile;
         std::vector<PageInfo> pages;
@@ -27,9 +34,17 @@ namespace assets {
 
     TextureInfo read_texture_info(AssetFile *file);
 
+    //bytes per texel for RGBA8, bytes per 4x4 block for the BC formats
+    uint32_t texture_block_size(TextureFormat format);
+
+    bool is_block_compressed(TextureFormat format);
+
+    //size in bytes of one width x height page stored in format
+    uint32_t texture_page_size(TextureFormat format, uint32_t width, uint32_t height);
+
     void unpack_texture(TextureInfo *info, const char *sourcebuffer, size_t sourceSize, char *destination);
 
     void unpack_texture_page(TextureInfo *info, int pageIndex, char *sourcebuffer, char *destination);
 
-    AssetFile pack_texture(TextureInfo *info, void *pixelData);
+    AssetFile pack_texture(TextureInfo *info, void *pixelData, const CompressionSettings &compression = {});
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include "asset_loader.h"
+#include "texture_asset.h"
+#include "mip_generation.h"
+
+#include <filesystem>
+
+//offline conversion of source art into the engine asset formats, run by slime_baker
+struct BakeOptions {
+    assets::CompressionSettings compression;
+
+    //RGBA8, or one of the BC formats encoded on the CPU
+    assets::TextureFormat textureFormat{assets::TextureFormat::RGBA8};
+    //false for normal maps and masks
+    bool srgb{true};
+    //full mip chain stored one level per page, off keeps only the top level
+    bool generateMips{true};
+    assets::MipFilter mipFilter{assets::MipFilter::Kaiser};
+    //worker threads for the block encoder, 0 uses every core
+    uint32_t threads{0};
+};
+
+//png/jpg/tga into a TEXI asset
+bool bake_texture(const std::filesystem::path &input, const std::filesystem::path &output, const BakeOptions &options);
+
+//obj into a MESH asset
+bool bake_mesh(const std::filesystem::path &input, const std::filesystem::path &output, const BakeOptions &options);
@@ -0,0 +1,103 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "Baker.h"
+
+#include "Log.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+static void print_usage() {
+    std::cout << "usage: slime_baker [options] <input> [output]\n"
+                 "  --codec none|lz4|lz4hc   compressor used for the binary blob (default lz4)\n"
+                 "  --level N                lz4 acceleration or lz4hc level 1-12, 0 for the codec default\n"
+                 "  --max-ratio R            store blocks raw when compressed/original is above R (default 0.8)\n"
+                 "  --format F               texture format rgba8|bc1|bc3|bc5|bc7 (default rgba8)\n"
+                 "  --linear                 texture holds data rather than colour, sampled without sRGB decode\n"
+                 "  --threads N              block encoder threads, 0 for every core\n"
+                 "  --mips none|box|kaiser   mip chain filter (default kaiser), sRGB textures are filtered in linear space\n"
+                 "textures (.png .jpg .tga) bake to .tx, meshes (.obj) to .mesh" << std::endl;
+}
+
+static assets::TextureFormat parse_texture_format(const char *name) {
+    if (strcmp(name, "rgba8") == 0) {
+        return assets::TextureFormat::RGBA8;
+    } else if (strcmp(name, "bc1") == 0) {
+        return assets::TextureFormat::BC1;
+    } else if (strcmp(name, "bc3") == 0) {
+        return assets::TextureFormat::BC3;
+    } else if (strcmp(name, "bc5") == 0) {
+        return assets::TextureFormat::BC5;
+    } else if (strcmp(name, "bc7") == 0) {
+        return assets::TextureFormat::BC7;
+    }
+    return assets::TextureFormat::Unknown;
+}
+
+int main(int argc, char *args[]) {
+    Log::init();
+
+    BakeOptions options;
+    std::filesystem::path input;
+    std::filesystem::path output;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(args[i], "--codec") == 0 && i + 1 < argc) {
+            options.compression.codec = assets::parse_codec(args[++i]);
+        } else if (strcmp(args[i], "--level") == 0 && i + 1 < argc) {
+            options.compression.level = std::atoi(args[++i]);
+        } else if (strcmp(args[i], "--max-ratio") == 0 && i + 1 < argc) {
+            options.compression.maxRatio = std::strtof(args[++i], nullptr);
+        } else if (strcmp(args[i], "--format") == 0 && i + 1 < argc) {
+            options.textureFormat = parse_texture_format(args[++i]);
+            if (options.textureFormat == assets::TextureFormat::Unknown) {
+                print_usage();
+                return 1;
+            }
+        } else if (strcmp(args[i], "--linear") == 0) {
+            options.srgb = false;
+        } else if (strcmp(args[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = (uint32_t) std::strtoul(args[++i], nullptr, 10);
+        } else if (strcmp(args[i], "--mips") == 0 && i + 1 < argc) {
+            const char *mips = args[++i];
+            options.generateMips = strcmp(mips, "none") != 0;
+            options.mipFilter = strcmp(mips, "box") == 0 ? assets::MipFilter::Box : assets::MipFilter::Kaiser;
+        } else if (args[i][0] == '-') {
+            print_usage();
+            return 1;
+        } else if (input.empty()) {
+            input = args[i];
+        } else {
+            output = args[i];
+        }
+    }
+
+    if (input.empty()) {
+        print_usage();
+        return 1;
+    }
+
+    std::string extension = input.extension().string();
+    bool isMesh = extension == ".obj";
+    bool isTexture = extension == ".png" || extension == ".jpg" || extension == ".tga";
+
+    if (output.empty()) {
+        output = input;
+        output.replace_extension(isMesh ? ".mesh" : ".tx");
+    }
+
+    bool baked;
+    if (isMesh) {
+        baked = bake_mesh(input, output, options);
+    } else if (isTexture) {
+        baked = bake_texture(input, output, options);
+    } else {
+        Log::error("Don't know how to bake " + input.string());
+        return 1;
+    }
+
+    return baked ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "Baker.h"
+
+#include "mesh_asset.h"
+#include "Log.h"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+
+#include "tiny_obj_loader.h"
+
+bool bake_mesh(const std::filesystem::path &input, const std::filesystem::path &output, const BakeOptions &options) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+
+    std::string warn;
+    std::string err;
+
+    //mtl files are looked up next to the obj
+    std::string baseDir = input.parent_path().string() + "/";
+    tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, input.string().c_str(), baseDir.c_str());
+    if (!warn.empty()) {
+        Log::warn(warn);
+    }
+    if (!err.empty()) {
+        Log::error(err);
+        return false;
+    }
+
+    //same unrolled triangle layout as Mesh::load_from_obj, with a trivial index buffer
+    std::vector<assets::Vertex_f32_PNCV> vertices;
+    std::vector<uint32_t> indices;
+
+    for (auto &shape: shapes) {
+        size_t index_offset = 0;
+        for (size_t f = 0; f < shape.mesh.num_face_vertices.size(); f++) {
+
+            //hardcode loading to triangles
+            int fv = 3;
+
+            for (size_t v = 0; v < fv; v++) {
+                tinyobj::index_t idx = shape.mesh.indices[index_offset + v];
+                assets::Vertex_f32_PNCV new_vert{};
+
+                new_vert.position[0] = attrib.vertices[3 * idx.vertex_index + 0];
+                new_vert.position[1] = attrib.vertices[3 * idx.vertex_index + 1];
+                new_vert.position[2] = attrib.vertices[3 * idx.vertex_index + 2];
+
+                if (idx.normal_index >= 0) {
+                    new_vert.normal[0] = attrib.normals[3 * idx.normal_index + 0];
+                    new_vert.normal[1] = attrib.normals[3 * idx.normal_index + 1];
+                    new_vert.normal[2] = attrib.normals[3 * idx.normal_index + 2];
+                }
+
+                if (idx.texcoord_index >= 0) {
+                    new_vert.uv[0] = attrib.texcoords[2 * idx.texcoord_index + 0];
+                    new_vert.uv[1] = 1 - attrib.texcoords[2 * idx.texcoord_index + 1];
+                }
+
+                if (!attrib.colors.empty()) {
+                    new_vert.color[0] = attrib.colors[3 * idx.vertex_index + 0];
+                    new_vert.color[1] = attrib.colors[3 * idx.vertex_index + 1];
+                    new_vert.color[2] = attrib.colors[3 * idx.vertex_index + 2];
+                } else {
+                    new_vert.color[0] = 1.0f;
+                    new_vert.color[1] = 1.0f;
+                    new_vert.color[2] = 1.0f;
+                }
+
+                indices.push_back(static_cast<uint32_t>(vertices.size()));
+                vertices.push_back(new_vert);
+            }
+            index_offset += fv;
+        }
+    }
+
+    assets::MeshInfo info{};
+    info.vertexFormat = assets::VertexFormat::PNCV_F32;
+    info.vertexBuferSize = vertices.size() * sizeof(assets::Vertex_f32_PNCV);
+    info.indexBuferSize = indices.size() * sizeof(uint32_t);
+    info.indexSize = sizeof(uint32_t);
+    info.originalFile = input.string();
+    info.bounds = assets::calculateBounds(vertices.data(), vertices.size());
+
+    assets::AssetFile file = assets::pack_mesh(&info, (char *) vertices.data(), (char *) indices.data(),
+                                               options.compression);
+
+    if (!assets::save_binaryfile(output.string().c_str(), file)) {
+        return false;
+    }
+
+    Log::info("Baked " + input.filename().string() + " -> " + output.filename().string() + " (" +
+              std::to_string(file.binaryBlob.size()) + " / " +
+              std::to_string(info.vertexBuferSize + info.indexBuferSize) + " bytes)");
+    return true;
+}
@@ -0,0 +1,68 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "Baker.h"
+
+#include "texture_asset.h"
+#include "block_compression.h"
+#include "Log.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+
+#include <stb_image.h>
+
+bool bake_texture(const std::filesystem::path &input, const std::filesystem::path &output, const BakeOptions &options) {
+    int texWidth, texHeight, texChannels;
+
+    stbi_uc *pixels = stbi_load(input.string().c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    if (!pixels) {
+        Log::error("Failed to load texture file " + input.string());
+        return false;
+    }
+
+    assets::TextureInfo info{};
+    info.textureFormat = options.textureFormat;
+    info.srgb = options.srgb;
+    info.originalFile = input.string();
+
+    std::vector<assets::MipLevel> levels;
+    if (options.generateMips) {
+        levels = assets::generate_mips(pixels, texWidth, texHeight, options.mipFilter, options.srgb);
+    } else {
+        levels.push_back({uint32_t(texWidth), uint32_t(texHeight),
+                          std::vector<uint8_t>(pixels, pixels + size_t(texWidth) * texHeight * 4)});
+    }
+    stbi_image_free(pixels);
+
+    //every level becomes a page, largest first, laid out back to back the way pack_texture reads them
+    std::vector<char> pageData;
+    info.textureSize = 0;
+    for (const assets::MipLevel &level: levels) {
+        assets::PageInfo page{};
+        page.width = level.width;
+        page.height = level.height;
+        page.originalSize = assets::texture_page_size(options.textureFormat, level.width, level.height);
+        info.pages.push_back(page);
+        info.textureSize += page.originalSize;
+
+        if (assets::is_block_compressed(options.textureFormat)) {
+            std::vector<char> blocks = assets::encode_blocks(options.textureFormat, level.pixels.data(), level.width,
+                                                             level.height, options.threads);
+            pageData.insert(pageData.end(), blocks.begin(), blocks.end());
+        } else {
+            pageData.insert(pageData.end(), level.pixels.begin(), level.pixels.end());
+        }
+    }
+
+    assets::AssetFile file = assets::pack_texture(&info, pageData.data(), options.compression);
+
+    if (!assets::save_binaryfile(output.string().c_str(), file)) {
+        return false;
+    }
+
+    Log::info("Baked " + input.filename().string() + " -> " + output.filename().string() + " (" +
+              std::to_string(file.binaryBlob.size()) + " / " + std::to_string(info.textureSize) + " bytes, " +
+              std::to_string(info.pages.size()) + " mips)");
+    return true;
+}
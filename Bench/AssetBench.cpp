@@ -0,0 +1,378 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "BenchHarness.h"
+
+#include "mesh_asset.h"
+#include "texture_asset.h"
+#include "block_compression.h"
+#include "mip_generation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+//synthetic assets, generated from fixed seeds so results stay comparable across commits.
+//sizes come from --param mesh_vertices=N, --param texture_size=N and --param texture_mips=0|1
+
+struct SyntheticMesh {
+    std::vector<assets::Vertex_f32_PNCV> vertices;
+    std::vector<uint32_t> indices;
+};
+
+struct SyntheticTexture {
+    assets::TextureInfo info;
+    std::vector<char> pixels;
+};
+
+//a noisy height field, smooth enough to compress like real terrain and not like random bytes
+static const SyntheticMesh &get_mesh() {
+    static SyntheticMesh mesh = [] {
+        SyntheticMesh result;
+
+        auto vertexCount = (size_t) bench_param("mesh_vertices", 100000);
+        auto side = (size_t) std::max(2.0, std::sqrt((double) vertexCount));
+
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+
+        result.vertices.resize(side * side);
+        for (size_t y = 0; y < side; y++) {
+            for (size_t x = 0; x < side; x++) {
+                assets::Vertex_f32_PNCV &vertex = result.vertices[y * side + x];
+                float fx = (float) x;
+                float fy = (float) y;
+
+                vertex.position[0] = fx;
+                vertex.position[1] = std::sin(fx * 0.1f) * std::cos(fy * 0.1f) * 4.0f + noise(rng);
+                vertex.position[2] = fy;
+
+                vertex.normal[0] = 0.0f;
+                vertex.normal[1] = 1.0f;
+                vertex.normal[2] = 0.0f;
+
+                vertex.color[0] = 1.0f;
+                vertex.color[1] = 1.0f;
+                vertex.color[2] = 1.0f;
+
+                vertex.uv[0] = fx / (float) side;
+                vertex.uv[1] = fy / (float) side;
+            }
+        }
+
+        for (size_t y = 0; y + 1 < side; y++) {
+            for (size_t x = 0; x + 1 < side; x++) {
+                auto i = (uint32_t) (y * side + x);
+                auto below = (uint32_t) (i + side);
+                result.indices.insert(result.indices.end(), {i, below, i + 1, i + 1, below, below + 1});
+            }
+        }
+
+        return result;
+    }();
+
+    return mesh;
+}
+
+//blocky gradients with a little noise, roughly how albedo textures behave under LZ4
+static const SyntheticTexture &get_texture() {
+    static SyntheticTexture texture = [] {
+        SyntheticTexture result;
+
+        auto size = (uint32_t) bench_param("texture_size", 1024);
+        bool withMips = bench_param("texture_mips", 1) != 0.0;
+
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> noise(0, 3);
+
+        result.info.textureFormat = assets::TextureFormat::RGBA8;
+        result.info.compressionMode = assets::CompressionMode::LZ4;
+        result.info.originalFile = "synthetic";
+        result.info.textureSize = 0;
+
+        for (uint32_t level = size; level > 0; level /= 2) {
+            assets::PageInfo page{};
+            page.width = level;
+            page.height = level;
+            page.originalSize = level * level * 4;
+            result.info.pages.push_back(page);
+            result.info.textureSize += page.originalSize;
+
+            size_t offset = result.pixels.size();
+            result.pixels.resize(offset + page.originalSize);
+            for (uint32_t y = 0; y < level; y++) {
+                for (uint32_t x = 0; x < level; x++) {
+                    char *pixel = result.pixels.data() + offset + (y * level + x) * 4;
+                    uint32_t tile = ((x * 16 / level) + (y * 16 / level)) % 4;
+                    pixel[0] = (char) (tile * 60 + noise(rng));
+                    pixel[1] = (char) (x * 255 / level);
+                    pixel[2] = (char) (y * 255 / level);
+                    pixel[3] = (char) 255;
+                }
+            }
+
+            if (!withMips) {
+                break;
+            }
+        }
+
+        return result;
+    }();
+
+    return texture;
+}
+
+static assets::MeshInfo make_mesh_info(const SyntheticMesh &mesh) {
+    assets::MeshInfo info{};
+    info.vertexBuferSize = mesh.vertices.size() * sizeof(assets::Vertex_f32_PNCV);
+    info.indexBuferSize = mesh.indices.size() * sizeof(uint32_t);
+    info.vertexFormat = assets::VertexFormat::PNCV_F32;
+    info.indexSize = sizeof(uint32_t);
+    info.originalFile = "synthetic";
+    info.bounds = assets::calculateBounds((assets::Vertex_f32_PNCV *) mesh.vertices.data(), mesh.vertices.size());
+    return info;
+}
+
+SLIME_BENCH("assets/calculate_bounds", [](BenchRun &run) {
+    const SyntheticMesh &mesh = get_mesh();
+    auto *vertices = (assets::Vertex_f32_PNCV *) mesh.vertices.data();
+
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        assets::MeshBounds bounds = assets::calculateBounds(vertices, mesh.vertices.size());
+        do_not_optimize(bounds);
+    }
+    run.bytesPerIteration = mesh.vertices.size() * sizeof(assets::Vertex_f32_PNCV);
+});
+
+SLIME_BENCH("assets/pack_mesh", [](BenchRun &run) {
+    const SyntheticMesh &mesh = get_mesh();
+    assets::MeshInfo info = make_mesh_info(mesh);
+
+    size_t compressedSize = 0;
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        assets::AssetFile file = assets::pack_mesh(&info, (char *) mesh.vertices.data(), (char *) mesh.indices.data());
+        compressedSize = file.binaryBlob.size();
+        do_not_optimize(file);
+    }
+
+    run.bytesPerIteration = info.vertexBuferSize + info.indexBuferSize;
+    run.set_counter("ratio", (double) compressedSize / (double) run.bytesPerIteration);
+});
+
+//the bake time codecs side by side, assets/pack_mesh above is the default lz4 setting
+struct CodecVariant {
+    const char *name;
+    assets::CompressionSettings settings;
+};
+
+static const CodecVariant codecVariants[] = {
+        {"lz4_fast8", {assets::CompressionCodec::LZ4,   8}},
+        {"lz4hc_4",   {assets::CompressionCodec::LZ4HC, 4}},
+        {"lz4hc_9",   {assets::CompressionCodec::LZ4HC, 9}},
+        {"lz4hc_12",  {assets::CompressionCodec::LZ4HC, 12}},
+};
+
+static bool registerCodecBenchmarks = [] {
+    for (const CodecVariant &variant: codecVariants) {
+        assets::CompressionSettings settings = variant.settings;
+
+        BenchRegistry::get().add(std::string("assets/pack_mesh_") + variant.name, [settings](BenchRun &run) {
+            const SyntheticMesh &mesh = get_mesh();
+            assets::MeshInfo info = make_mesh_info(mesh);
+
+            size_t compressedSize = 0;
+            run.reset_timer();
+            for (uint64_t i = 0; i < run.iterations; i++) {
+                assets::AssetFile file = assets::pack_mesh(&info, (char *) mesh.vertices.data(),
+                                                           (char *) mesh.indices.data(), settings);
+                compressedSize = file.binaryBlob.size();
+                do_not_optimize(file);
+            }
+
+            run.bytesPerIteration = info.vertexBuferSize + info.indexBuferSize;
+            run.set_counter("ratio", (double) compressedSize / (double) run.bytesPerIteration);
+        });
+
+        BenchRegistry::get().add(std::string("assets/pack_texture_") + variant.name, [settings](BenchRun &run) {
+            const SyntheticTexture &texture = get_texture();
+            assets::TextureInfo info = texture.info;
+
+            size_t compressedSize = 0;
+            run.reset_timer();
+            for (uint64_t i = 0; i < run.iterations; i++) {
+                assets::AssetFile file = assets::pack_texture(&info, (void *) texture.pixels.data(), settings);
+                compressedSize = file.binaryBlob.size();
+                do_not_optimize(file);
+            }
+
+            run.bytesPerIteration = texture.pixels.size();
+            run.set_counter("ratio", (double) compressedSize / (double) run.bytesPerIteration);
+        });
+
+        //decompression cost of the better ratio, should match assets/unpack_texture
+        BenchRegistry::get().add(std::string("assets/unpack_texture_") + variant.name, [settings](BenchRun &run) {
+            const SyntheticTexture &texture = get_texture();
+            assets::TextureInfo info = texture.info;
+            assets::AssetFile file = assets::pack_texture(&info, (void *) texture.pixels.data(), settings);
+            info = assets::read_texture_info(&file);
+
+            std::vector<char> pixels(texture.pixels.size());
+
+            run.reset_timer();
+            for (uint64_t i = 0; i < run.iterations; i++) {
+                assets::unpack_texture(&info, file.binaryBlob.data(), file.binaryBlob.size(), pixels.data());
+                do_not_optimize(pixels.data());
+            }
+
+            run.bytesPerIteration = texture.pixels.size();
+        });
+    }
+    return true;
+}();
+
+SLIME_BENCH("assets/read_mesh_info", [](BenchRun &run) {
+    const SyntheticMesh &mesh = get_mesh();
+    assets::MeshInfo info = make_mesh_info(mesh);
+    assets::AssetFile file = assets::pack_mesh(&info, (char *) mesh.vertices.data(), (char *) mesh.indices.data());
+
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        assets::MeshInfo readInfo = assets::read_mesh_info(&file);
+        do_not_optimize(readInfo);
+    }
+});
+
+SLIME_BENCH("assets/unpack_mesh", [](BenchRun &run) {
+    const SyntheticMesh &mesh = get_mesh();
+    assets::MeshInfo info = make_mesh_info(mesh);
+    assets::AssetFile file = assets::pack_mesh(&info, (char *) mesh.vertices.data(), (char *) mesh.indices.data());
+    info = assets::read_mesh_info(&file);
+
+    std::vector<char> vertices(info.vertexBuferSize);
+    std::vector<char> indices(info.indexBuferSize);
+
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        assets::unpack_mesh(&info, file.binaryBlob.data(), file.binaryBlob.size(), vertices.data(), indices.data());
+        do_not_optimize(vertices.data());
+    }
+
+    run.bytesPerIteration = info.vertexBuferSize + info.indexBuferSize;
+    run.set_counter("ratio", (double) file.binaryBlob.size() / (double) run.bytesPerIteration);
+});
+
+SLIME_BENCH("assets/pack_texture", [](BenchRun &run) {
+    const SyntheticTexture &texture = get_texture();
+    assets::TextureInfo info = texture.info;
+
+    size_t compressedSize = 0;
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        assets::AssetFile file = assets::pack_texture(&info, (void *) texture.pixels.data());
+        compressedSize = file.binaryBlob.size();
+        do_not_optimize(file);
+    }
+
+    run.bytesPerIteration = texture.pixels.size();
+    run.set_counter("ratio", (double) compressedSize / (double) run.bytesPerIteration);
+    run.set_counter("pages", (double) info.pages.size());
+});
+
+SLIME_BENCH("assets/unpack_texture", [](BenchRun &run) {
+    const SyntheticTexture &texture = get_texture();
+    assets::TextureInfo info = texture.info;
+    assets::AssetFile file = assets::pack_texture(&info, (void *) texture.pixels.data());
+    info = assets::read_texture_info(&file);
+
+    std::vector<char> pixels(texture.pixels.size());
+
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        assets::unpack_texture(&info, file.binaryBlob.data(), file.binaryBlob.size(), pixels.data());
+        do_not_optimize(pixels.data());
+    }
+
+    run.bytesPerIteration = texture.pixels.size();
+    run.set_counter("ratio", (double) file.binaryBlob.size() / (double) run.bytesPerIteration);
+});
+
+//the path the engine takes when uploading, page by page into a staging buffer
+SLIME_BENCH("assets/unpack_texture_pages", [](BenchRun &run) {
+    const SyntheticTexture &texture = get_texture();
+    assets::TextureInfo info = texture.info;
+    assets::AssetFile file = assets::pack_texture(&info, (void *) texture.pixels.data());
+    info = assets::read_texture_info(&file);
+
+    std::vector<char> pixels(texture.pixels.size());
+
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        size_t offset = 0;
+        for (int page = 0; page < (int) info.pages.size(); page++) {
+            assets::unpack_texture_page(&info, page, file.binaryBlob.data(), pixels.data() + offset);
+            offset += info.pages[page].originalSize;
+        }
+        do_not_optimize(pixels.data());
+    }
+
+    run.bytesPerIteration = texture.pixels.size();
+});
+
+//CPU block encoders on the top mip of the synthetic texture, one thread so the numbers are per core
+static bool registerBlockBenchmarks = [] {
+    static const std::pair<const char *, assets::TextureFormat> formats[] = {
+            {"bc1", assets::TextureFormat::BC1},
+            {"bc3", assets::TextureFormat::BC3},
+            {"bc5", assets::TextureFormat::BC5},
+            {"bc7", assets::TextureFormat::BC7},
+    };
+
+    for (const auto &[name, format]: formats) {
+        assets::TextureFormat blockFormat = format;
+        BenchRegistry::get().add(std::string("assets/encode_") + name, [blockFormat](BenchRun &run) {
+            const SyntheticTexture &texture = get_texture();
+            const assets::PageInfo &page = texture.info.pages[0];
+
+            run.reset_timer();
+            for (uint64_t i = 0; i < run.iterations; i++) {
+                std::vector<char> blocks = assets::encode_blocks(blockFormat, (const uint8_t *) texture.pixels.data(),
+                                                                 page.width, page.height, 1);
+                do_not_optimize(blocks.data());
+            }
+
+            run.bytesPerIteration = page.originalSize;
+        });
+    }
+    return true;
+}();
+
+SLIME_BENCH("assets/generate_mips_box_srgb", [](BenchRun &run) {
+    const SyntheticTexture &texture = get_texture();
+    const assets::PageInfo &page = texture.info.pages[0];
+
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        std::vector<assets::MipLevel> levels = assets::generate_mips((const uint8_t *) texture.pixels.data(),
+                                                                     page.width, page.height,
+                                                                     assets::MipFilter::Box, true);
+        do_not_optimize(levels.data());
+    }
+    run.bytesPerIteration = page.originalSize;
+});
+
+SLIME_BENCH("assets/generate_mips_kaiser_srgb", [](BenchRun &run) {
+    const SyntheticTexture &texture = get_texture();
+    const assets::PageInfo &page = texture.info.pages[0];
+
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        std::vector<assets::MipLevel> levels = assets::generate_mips((const uint8_t *) texture.pixels.data(),
+                                                                     page.width, page.height,
+                                                                     assets::MipFilter::Kaiser, true);
+        do_not_optimize(levels.data());
+    }
+    run.bytesPerIteration = page.originalSize;
+});
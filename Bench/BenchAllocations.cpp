@@ -0,0 +1,81 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "BenchHarness.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+//replaces the global allocation functions for slime_bench only, so allocations per call can be reported
+
+static std::atomic<uint64_t> gAllocationCount{0};
+
+uint64_t bench_allocation_count() {
+    return gAllocationCount.load(std::memory_order_relaxed);
+}
+
+static void *counted_alloc(std::size_t size) {
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+static void *counted_aligned_alloc(std::size_t size, std::align_val_t alignment) {
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    auto align = (std::size_t) alignment;
+#ifdef _MSC_VER
+    void *ptr = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    //aligned_alloc wants the size rounded up to the alignment
+    void *ptr = std::aligned_alloc(align, ((size == 0 ? 1 : size) + align - 1) / align * align);
+#endif
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+static void aligned_free(void *ptr) {
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void *operator new(std::size_t size) { return counted_alloc(size); }
+
+void *operator new[](std::size_t size) { return counted_alloc(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    try { return counted_alloc(size); } catch (...) { return nullptr; }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    try { return counted_alloc(size); } catch (...) { return nullptr; }
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) { return counted_aligned_alloc(size, alignment); }
+
+void *operator new[](std::size_t size, std::align_val_t alignment) { return counted_aligned_alloc(size, alignment); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::align_val_t) noexcept { aligned_free(ptr); }
+
+void operator delete[](void *ptr, std::align_val_t) noexcept { aligned_free(ptr); }
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { aligned_free(ptr); }
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { aligned_free(ptr); }
@@ -0,0 +1,97 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "BenchHarness.h"
+
+#include <algorithm>
+
+void BenchRun::reset_timer() {
+    start = std::chrono::steady_clock::now();
+    allocationsAtStart = bench_allocation_count();
+}
+
+void BenchRun::set_counter(const std::string &name, double value) {
+    for (auto &counter: counters) {
+        if (counter.first == name) {
+            counter.second = value;
+            return;
+        }
+    }
+    counters.emplace_back(name, value);
+}
+
+std::map<std::string, double> &bench_params() {
+    static std::map<std::string, double> params;
+    return params;
+}
+
+double bench_param(const std::string &name, double defaultValue) {
+    auto it = bench_params().find(name);
+    return it != bench_params().end() ? it->second : defaultValue;
+}
+
+BenchRegistry &BenchRegistry::get() {
+    static BenchRegistry registry;
+    return registry;
+}
+
+void BenchRegistry::add(const std::string &name, BenchFunction function) {
+    mBenchmarks.emplace_back(name, std::move(function));
+}
+
+static double run_timed(const BenchFunction &function, BenchRun &run, uint64_t *allocations = nullptr) {
+    run.reset_timer();
+    function(run);
+    auto end = std::chrono::steady_clock::now();
+    uint64_t allocationsAtEnd = bench_allocation_count();
+
+    if (allocations != nullptr) {
+        *allocations = allocationsAtEnd - run.allocationsAtStart;
+    }
+    return std::chrono::duration<double>(end - run.start).count();
+}
+
+std::vector<BenchResult> BenchRegistry::run(const std::string &filter, double minSeconds,
+                                            uint32_t repetitions) const {
+    std::vector<BenchResult> results;
+
+    for (const auto &[name, function]: mBenchmarks) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        //grow the iteration count until one run takes long enough to time reliably
+        BenchRun run;
+        run.iterations = 1;
+        double seconds = run_timed(function, run);
+        while (seconds < minSeconds && run.iterations < (1ull << 40)) {
+            double scale = seconds > 0.0 ? std::clamp(minSeconds * 1.2 / seconds, 2.0, 100.0) : 100.0;
+            run.iterations = (uint64_t) ((double) run.iterations * scale);
+            seconds = run_timed(function, run);
+        }
+
+        std::vector<double> nsPerIteration;
+        nsPerIteration.reserve(repetitions);
+        uint64_t allocations = 0;
+        for (uint32_t i = 0; i < std::max(repetitions, 1u); i++) {
+            seconds = run_timed(function, run, &allocations);
+            nsPerIteration.push_back(seconds * 1e9 / (double) run.iterations);
+        }
+        std::sort(nsPerIteration.begin(), nsPerIteration.end());
+
+        BenchResult result;
+        result.name = name;
+        result.iterations = run.iterations;
+        result.nsPerIteration = nsPerIteration[nsPerIteration.size() / 2];
+        if (run.bytesPerIteration > 0 && result.nsPerIteration > 0.0) {
+            result.megabytesPerSecond = (double) run.bytesPerIteration / (result.nsPerIteration * 1e-9) / 1e6;
+        }
+        result.allocationsPerIteration = (double) allocations / (double) run.iterations;
+        result.counters = run.counters;
+
+        results.push_back(result);
+    }
+
+    return results;
+}
@@ -0,0 +1,91 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+//number of operator new calls made so far by the process, counted in BenchAllocations.cpp
+uint64_t bench_allocation_count();
+
+//handed to every benchmark, the body runs `iterations` times and reports what it processed
+struct BenchRun {
+    uint64_t iterations{1};
+
+    //timing and allocation counting start here. Benchmarks with setup call reset_timer() right before their loop
+    std::chrono::steady_clock::time_point start;
+    uint64_t allocationsAtStart{0};
+
+    void reset_timer();
+
+    //bytes handled per iteration, turns into MB/s in the report
+    uint64_t bytesPerIteration{0};
+
+    //extra per-benchmark numbers such as compression ratio, reported as-is
+    std::vector<std::pair<std::string, double>> counters;
+
+    void set_counter(const std::string &name, double value);
+};
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations{0};
+    //median of the repetitions
+    double nsPerIteration{0.0};
+    double megabytesPerSecond{0.0};
+    //heap allocations per iteration of the timed loop
+    double allocationsPerIteration{0.0};
+    std::vector<std::pair<std::string, double>> counters;
+};
+
+using BenchFunction = std::function<void(BenchRun &)>;
+
+class BenchRegistry {
+public:
+    static BenchRegistry &get();
+
+    void add(const std::string &name, BenchFunction function);
+
+    //runs every benchmark whose name contains filter, each one long enough to reach minSeconds per repetition
+    std::vector<BenchResult> run(const std::string &filter, double minSeconds, uint32_t repetitions) const;
+
+private:
+    std::vector<std::pair<std::string, BenchFunction>> mBenchmarks;
+};
+
+//named numeric parameters set with --param name=value, so data sizes can change without rebuilding
+std::map<std::string, double> &bench_params();
+
+//returns the parameter, or defaultValue if it was not given on the command line
+double bench_param(const std::string &name, double defaultValue);
+
+//keeps the compiler from optimizing away a value the benchmark computed
+template<typename T>
+inline void do_not_optimize(T const &value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+struct BenchRegistration {
+    BenchRegistration(const std::string &name, BenchFunction function) {
+        BenchRegistry::get().add(name, std::move(function));
+    }
+};
+
+#define SLIME_BENCH_CONCAT_INNER(a, b) a##b
+#define SLIME_BENCH_CONCAT(a, b) SLIME_BENCH_CONCAT_INNER(a, b)
+
+//registers a benchmark at static init time: SLIME_BENCH("group/name", [](BenchRun &run) { ... });
+#define SLIME_BENCH(name, ...) \
+    static BenchRegistration SLIME_BENCH_CONCAT(benchRegistration, __LINE__){name, __VA_ARGS__}
@@ -0,0 +1,98 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "BenchHarness.h"
+
+#include "json.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static void print_results(const std::vector<BenchResult> &results) {
+    std::printf("%-48s %14s %12s %10s %12s\n", "benchmark", "ns/iter", "MB/s", "allocs", "iterations");
+    for (const BenchResult &result: results) {
+        std::printf("%-48s %14.1f ", result.name.c_str(), result.nsPerIteration);
+        if (result.megabytesPerSecond > 0.0) {
+            std::printf("%12.1f ", result.megabytesPerSecond);
+        } else {
+            std::printf("%12s ", "-");
+        }
+        std::printf("%10.2f %12llu", result.allocationsPerIteration, (unsigned long long) result.iterations);
+
+        for (const auto &[name, value]: result.counters) {
+            std::printf("  %s=%.3f", name.c_str(), value);
+        }
+        std::printf("\n");
+    }
+}
+
+static bool write_json(const std::vector<BenchResult> &results, const std::string &path) {
+    //parameters go in the report so results are only compared between runs over the same data
+    nlohmann::json report;
+    report["params"] = nlohmann::json::object();
+    for (const auto &[name, value]: bench_params()) {
+        report["params"][name] = value;
+    }
+    report["results"] = nlohmann::json::array();
+
+    for (const BenchResult &result: results) {
+        nlohmann::json entry;
+        entry["name"] = result.name;
+        entry["iterations"] = result.iterations;
+        entry["ns_per_iteration"] = result.nsPerIteration;
+        entry["mb_per_second"] = result.megabytesPerSecond;
+        entry["allocations_per_iteration"] = result.allocationsPerIteration;
+        for (const auto &[name, value]: result.counters) {
+            entry["counters"][name] = value;
+        }
+        report["results"].push_back(entry);
+    }
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    file << report.dump(4);
+    return true;
+}
+
+int main(int argc, char *args[]) {
+    std::string filter;
+    std::string jsonPath;
+    double minSeconds = 0.25;
+    uint32_t repetitions = 5;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(args[i], "--filter") == 0 && i + 1 < argc) {
+            filter = args[++i];
+        } else if (strcmp(args[i], "--min-time") == 0 && i + 1 < argc) {
+            minSeconds = std::strtod(args[++i], nullptr);
+        } else if (strcmp(args[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = (uint32_t) std::strtoul(args[++i], nullptr, 10);
+        } else if (strcmp(args[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = args[++i];
+        } else if (strcmp(args[i], "--param") == 0 && i + 1 < argc) {
+            //name=value
+            std::string param = args[++i];
+            size_t split = param.find('=');
+            if (split != std::string::npos) {
+                bench_params()[param.substr(0, split)] = std::strtod(param.c_str() + split + 1, nullptr);
+            }
+        }
+    }
+
+    std::vector<BenchResult> results = BenchRegistry::get().run(filter, minSeconds, repetitions);
+    print_results(results);
+
+    if (!jsonPath.empty() && !write_json(results, jsonPath)) {
+        return 1;
+    }
+
+    return 0;
+}
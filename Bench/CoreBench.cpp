@@ -0,0 +1,77 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "BenchHarness.h"
+
+#include "Benchmark.h"
+#include "TransformSystem.h"
+
+#include <random>
+
+//the statistics the benchmark mode runs over a few thousand frame times
+SLIME_BENCH("core/summarize_timings_10k", [](BenchRun &run) {
+    std::mt19937 rng(1234);
+    std::lognormal_distribution<double> frameTimes(2.8, 0.2);
+
+    std::vector<double> samples(10000);
+    for (double &sample: samples) {
+        sample = frameTimes(rng);
+    }
+
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        TimingSummary summary = summarize_timings(samples);
+        do_not_optimize(summary);
+    }
+    run.bytesPerIteration = samples.size() * sizeof(double);
+});
+
+SLIME_BENCH("core/camera_path_sample", [](BenchRun &run) {
+    CameraPath path = CameraPath::default_flythrough();
+
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        glm::mat4 view = path.sample_view((float) (i % 1000) / 1000.0f);
+        do_not_optimize(view);
+    }
+});
+
+//a forest of 256 chains 64 deep, about what a skinned crowd looks like. Only the roots move, so every update
+//recomputes the whole hierarchy below them
+static void bench_transform_update(BenchRun &run, uint32_t threadCount) {
+    TransformSystem transforms;
+    transforms.set_consumer_count(1);
+
+    std::vector<TransformId> roots;
+    for (uint32_t r = 0; r < 256; r++) {
+        TransformId parent = transforms.create(glm::vec3{(float) r, 0.0f, 0.0f});
+        roots.push_back(parent);
+        for (uint32_t d = 1; d < 64; d++) {
+            parent = transforms.create(glm::vec3{0.0f, 1.0f, 0.0f}, glm::angleAxis(0.1f, glm::vec3{0.0f, 0.0f, 1.0f}),
+                                       glm::vec3{1.0f}, parent);
+        }
+    }
+    transforms.update(threadCount);
+    transforms.clear_pending(0);
+
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        for (TransformId root: roots) {
+            transforms.set_translation(root, glm::vec3{(float) root, (float) (i % 7), 0.0f});
+        }
+        uint32_t changed = transforms.update(threadCount);
+        do_not_optimize(changed);
+        transforms.clear_pending(0);
+    }
+    run.bytesPerIteration = transforms.get_count() * sizeof(glm::mat4);
+    run.set_counter("transforms", (double) transforms.get_count());
+}
+
+SLIME_BENCH("core/transform_update_16k_1_thread", [](BenchRun &run) {
+    bench_transform_update(run, 1);
+});
+
+SLIME_BENCH("core/transform_update_16k_all_threads", [](BenchRun &run) {
+    bench_transform_update(run, 0);
+});
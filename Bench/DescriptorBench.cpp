@@ -0,0 +1,192 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "BenchHarness.h"
+
+#include "VulkanHash.h"
+
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+//layouts like the ones the engine and reflected shaders build
+
+static VkDescriptorSetLayoutBinding make_binding(uint32_t binding, VkDescriptorType type, VkShaderStageFlags stages,
+                                                 uint32_t count = 1) {
+    VkDescriptorSetLayoutBinding result{};
+    result.binding = binding;
+    result.descriptorType = type;
+    result.descriptorCount = count;
+    result.stageFlags = stages;
+    return result;
+}
+
+struct BenchLayout {
+    const char *name;
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+};
+
+static const std::vector<BenchLayout> &get_layouts() {
+    static std::vector<BenchLayout> layouts = [] {
+        const VkShaderStageFlags vertex = VK_SHADER_STAGE_VERTEX_BIT;
+        const VkShaderStageFlags fragment = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        std::vector<BenchLayout> result;
+        result.push_back({"global", {make_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, vertex),
+                                     make_binding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, vertex | fragment)}});
+        result.push_back({"object", {make_binding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, vertex)}});
+
+        BenchLayout material{"material", {}};
+        for (uint32_t i = 0; i < 4; i++) {
+            material.bindings.push_back(make_binding(i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, fragment));
+        }
+        result.push_back(material);
+
+        //a deferred lighting pass, past the layout cache's inline binding storage
+        BenchLayout lighting{"lighting", {}};
+        for (uint32_t i = 0; i < 6; i++) {
+            lighting.bindings.push_back(make_binding(i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, fragment));
+        }
+        lighting.bindings.push_back(make_binding(6, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, fragment));
+        lighting.bindings.push_back(make_binding(7, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, fragment));
+        lighting.bindings.push_back(make_binding(8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, fragment));
+        lighting.bindings.push_back(make_binding(9, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, fragment, 64));
+        lighting.bindings.push_back(make_binding(10, VK_DESCRIPTOR_TYPE_SAMPLER, fragment));
+        lighting.bindings.push_back(make_binding(11, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, fragment));
+        result.push_back(lighting);
+
+        return result;
+    }();
+    return layouts;
+}
+
+//the two schemes the caches used before vkutil::hash_descriptor_bindings, kept as a baseline
+
+static uint32_t legacy_stringstream_hash(const VkDescriptorSetLayoutBinding *bindings, uint32_t count) {
+    std::stringstream ss;
+    ss << 0u;
+    ss << count;
+    for (uint32_t i = 0; i < count; i++) {
+        ss << bindings[i].binding;
+        ss << bindings[i].descriptorCount;
+        ss << bindings[i].descriptorType;
+        ss << bindings[i].stageFlags;
+    }
+    std::string str = ss.str();
+
+    //FNV-1a 32, including the terminator like the recursive version did
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i <= str.length(); i++) {
+        hash = (hash ^ (uint32_t) (unsigned char) str.c_str()[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static size_t legacy_xor_hash(const VkDescriptorSetLayoutBinding *bindings, uint32_t count) {
+    size_t result = std::hash<size_t>()(count);
+    for (uint32_t i = 0; i < count; i++) {
+        const VkDescriptorSetLayoutBinding &b = bindings[i];
+        size_t bindingHash = b.binding | b.descriptorType << 8 | b.descriptorCount << 16 | b.stageFlags << 24;
+        result ^= std::hash<size_t>()(bindingHash);
+    }
+    return result;
+}
+
+static bool registerLayoutBenchmarks = [] {
+    for (size_t layoutIndex = 0; layoutIndex < get_layouts().size(); layoutIndex++) {
+        std::string name = get_layouts()[layoutIndex].name;
+
+        BenchRegistry::get().add("descriptors/hash_layout_" + name, [layoutIndex](BenchRun &run) {
+            const BenchLayout &layout = get_layouts()[layoutIndex];
+
+            run.reset_timer();
+            for (uint64_t i = 0; i < run.iterations; i++) {
+                uint64_t hash = vkutil::hash_descriptor_bindings(layout.bindings.data(),
+                                                                 (uint32_t) layout.bindings.size(), 0);
+                do_not_optimize(hash);
+            }
+            run.bytesPerIteration = layout.bindings.size() * sizeof(VkDescriptorSetLayoutBinding);
+        });
+
+        BenchRegistry::get().add("descriptors/hash_layout_" + name + "_stringstream", [layoutIndex](BenchRun &run) {
+            const BenchLayout &layout = get_layouts()[layoutIndex];
+
+            run.reset_timer();
+            for (uint64_t i = 0; i < run.iterations; i++) {
+                uint32_t hash = legacy_stringstream_hash(layout.bindings.data(), (uint32_t) layout.bindings.size());
+                do_not_optimize(hash);
+            }
+            run.bytesPerIteration = layout.bindings.size() * sizeof(VkDescriptorSetLayoutBinding);
+        });
+
+        BenchRegistry::get().add("descriptors/hash_layout_" + name + "_xor", [layoutIndex](BenchRun &run) {
+            const BenchLayout &layout = get_layouts()[layoutIndex];
+
+            run.reset_timer();
+            for (uint64_t i = 0; i < run.iterations; i++) {
+                size_t hash = legacy_xor_hash(layout.bindings.data(), (uint32_t) layout.bindings.size());
+                do_not_optimize(hash);
+            }
+            run.bytesPerIteration = layout.bindings.size() * sizeof(VkDescriptorSetLayoutBinding);
+        });
+    }
+    return true;
+}();
+
+//every layout of one to three bindings over common types and stages, all distinct. Reports how many hashes
+//each scheme shares between different layouts
+SLIME_BENCH("descriptors/hash_layout_collisions", [](BenchRun &run) {
+    const VkDescriptorType types[] = {VK_DESCRIPTOR_TYPE_SAMPLER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                      VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC};
+    const VkShaderStageFlags stages[] = {VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT,
+                                         VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT};
+    const uint32_t choices = (uint32_t) (std::size(types) * std::size(stages));
+
+    std::vector<std::vector<VkDescriptorSetLayoutBinding>> layouts;
+    for (uint32_t bindingCount = 1; bindingCount <= 3; bindingCount++) {
+        uint32_t combinations = 1;
+        for (uint32_t i = 0; i < bindingCount; i++) {
+            combinations *= choices;
+        }
+
+        for (uint32_t combination = 0; combination < combinations; combination++) {
+            std::vector<VkDescriptorSetLayoutBinding> bindings;
+            uint32_t remaining = combination;
+            for (uint32_t binding = 0; binding < bindingCount; binding++) {
+                uint32_t choice = remaining % choices;
+                remaining /= choices;
+                bindings.push_back(make_binding(binding, types[choice % std::size(types)],
+                                                stages[choice / std::size(types)]));
+            }
+            layouts.push_back(std::move(bindings));
+        }
+    }
+
+    std::unordered_set<uint64_t> hashes;
+    std::unordered_set<uint64_t> stringstreamHashes;
+    std::unordered_set<uint64_t> xorHashes;
+    for (const auto &bindings: layouts) {
+        auto count = (uint32_t) bindings.size();
+        hashes.insert(vkutil::hash_descriptor_bindings(bindings.data(), count, 0));
+        stringstreamHashes.insert(legacy_stringstream_hash(bindings.data(), count));
+        xorHashes.insert(legacy_xor_hash(bindings.data(), count));
+    }
+
+    run.reset_timer();
+    for (uint64_t i = 0; i < run.iterations; i++) {
+        uint64_t combined = 0;
+        for (const auto &bindings: layouts) {
+            combined += vkutil::hash_descriptor_bindings(bindings.data(), (uint32_t) bindings.size(), 0);
+        }
+        do_not_optimize(combined);
+    }
+
+    run.set_counter("layouts", (double) layouts.size());
+    run.set_counter("collisions", (double) (layouts.size() - hashes.size()));
+    run.set_counter("collisions_stringstream", (double) (layouts.size() - stringstreamHashes.size()));
+    run.set_counter("collisions_xor", (double) (layouts.size() - xorHashes.size()));
+});
@@ -1,3 +1,5 @@
-C:/VulkanSDK/1.2.198.1/Bin/glslc.exe lit.vert -o lit.vert.spv
-C:/VulkanSDK/1.2.198.1/Bin/glslc.exe lit.frag -o lit.frag.spv
+cd /d %~dp0
+if not exist ..\..\build\Shaders mkdir ..\..\build\Shaders
+C:/VulkanSDK/1.2.198.1/Bin/glslc.exe --target-env=vulkan1.2 lit.vert -o ../../build/Shaders/lit.vert.spv
+C:/VulkanSDK/1.2.198.1/Bin/glslc.exe --target-env=vulkan1.2 lit.frag -o ../../build/Shaders/lit.frag.spv
 pause
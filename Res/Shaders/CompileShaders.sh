@@ -1,4 +1,7 @@
 #!/bin/bash
+# compiles into the directory the engine loads SPIR-V from, the CMake build does the same on its own
+cd "$(dirname "$0")"
+mkdir -p ../../build/Shaders
 
-glslangValidator -V lit.vert -o lit.vert.spv
-glslangValidator -V lit.frag -o lit.frag.spv
+glslangValidator -V --target-env vulkan1.2 lit.vert -o ../../build/Shaders/lit.vert.spv
+glslangValidator -V --target-env vulkan1.2 lit.frag -o ../../build/Shaders/lit.frag.spv
@@ -1,10 +1,21 @@
 //glsl version 4.5
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 //shader input
 layout (location = 0) in vec3 inColour;
 layout (location = 1) in vec2 texCoord;
-layout (set = 2, binding = 0) uniform sampler2D tex1;
+layout (location = 2) flat in uint textureIndex;
+layout (location = 3) in float viewDepth;
+
+//material features, see ShaderFeatureBits. Each pipeline variant sets these, and the driver removes
+//the code behind the ones that are false
+layout (constant_id = 0) const bool ALPHA_TEST = false;
+layout (constant_id = 1) const bool VERTEX_COLOUR = false;
+layout (constant_id = 2) const bool FOG = false;
+
+//every material texture, indexed with the object's texture index
+layout (set = 2, binding = 0) uniform sampler2D textures[];
 
 
 //output write
@@ -21,6 +32,19 @@ layout(set = 0, binding = 1) uniform  SceneData{
 
 void main()
 {
-    vec3 colour = texture(tex1, texCoord).xyz;
+    vec4 texel = texture(textures[nonuniformEXT(textureIndex)], texCoord);
+    if (ALPHA_TEST && texel.a < 0.5f) {
+        discard;
+    }
+
+    vec3 colour = texel.rgb;
+    if (VERTEX_COLOUR) {
+        colour *= inColour;
+    }
+    if (FOG) {
+        float fogAmount = smoothstep(sceneData.fogDistances.x, sceneData.fogDistances.y, viewDepth);
+        colour = mix(colour, sceneData.fogColour.rgb, fogAmount);
+    }
+
     outFragColour = vec4(colour, 1.0f);
 }
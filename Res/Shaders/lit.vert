@@ -6,6 +6,11 @@ layout (location = 3) in vec3 vColour;
 
 layout (location = 0) out vec3 outColour;
 layout (location = 1) out vec2 texCoord;
+layout (location = 2) flat out uint textureIndex;
+layout (location = 3) out float viewDepth;
+
+//material features, see ShaderFeatureBits. Only fog needs anything from the vertex stage
+layout (constant_id = 2) const bool FOG = false;
 
 layout(set = 0, binding = 0) uniform  CameraBuffer{
     mat4 view;
@@ -15,6 +20,7 @@ layout(set = 0, binding = 0) uniform  CameraBuffer{
 
 struct ObjectData{
     mat4 model;
+    uint textureIndex;
 };
 
 //all object matrices
@@ -23,18 +29,16 @@ layout(std140, set = 1, binding = 0) readonly buffer ObjectBuffer{
     ObjectData objects[];
 } objectBuffer;
 
-//push constants block
-layout(push_constant) uniform constants
-{
-    vec4 data;
-    mat4 render_matrix;
-} PushConstants;
+//no push constants, the draw's object is gl_BaseInstance. A shader that needs a draw id declares
+//layout(push_constant) uniform DrawConstants { uint drawId; } and the engine pushes it
 
 void main()
 {
     mat4 modelMatrix = objectBuffer.objects[gl_BaseInstance].model;
-    mat4 transformMatrix = (cameraData.viewproj * modelMatrix);
-    gl_Position = transformMatrix * vec4(vPosition, 1.0f);
+    vec4 worldPosition = modelMatrix * vec4(vPosition, 1.0f);
+    gl_Position = cameraData.viewproj * worldPosition;
+    viewDepth = FOG ? -(cameraData.view * worldPosition).z : 0.0f;
     outColour = vColour;
     texCoord = vTexCoord;
+    textureIndex = objectBuffer.objects[gl_BaseInstance].textureIndex;
 }
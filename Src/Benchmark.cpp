@@ -0,0 +1,226 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "Benchmark.h"
+
+#include "Log.h"
+#include "json.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <filesystem>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtx/transform.hpp>
+
+CameraPath CameraPath::default_flythrough() {
+    CameraPath path;
+
+    //a loop around the empire map with changing height and distance so near and far geometry both get covered
+    const glm::vec3 center = {5.0f, -10.0f, 0.0f};
+    const int keyframeCount = 8;
+    for (int i = 0; i <= keyframeCount; i++) {
+        float angle = glm::two_pi<float>() * (float) i / (float) keyframeCount;
+        float radius = (i % 2 == 0) ? 45.0f : 25.0f;
+        float height = (i % 2 == 0) ? 20.0f : 6.0f;
+
+        glm::vec3 position = center + glm::vec3{std::cos(angle) * radius, height, std::sin(angle) * radius};
+        path.add_keyframe(position, center);
+    }
+
+    return path;
+}
+
+void CameraPath::add_keyframe(const glm::vec3 &position, const glm::vec3 &target) {
+    mKeyframes.push_back({position, target});
+}
+
+glm::mat4 CameraPath::sample_view(float t) const {
+    if (mKeyframes.empty()) {
+        return glm::mat4{1.0f};
+    }
+    if (mKeyframes.size() == 1) {
+        return glm::lookAt(mKeyframes[0].position, mKeyframes[0].target, glm::vec3{0.0f, 1.0f, 0.0f});
+    }
+
+    t = std::clamp(t, 0.0f, 1.0f);
+    const auto last = (int) mKeyframes.size() - 1;
+
+    float segment = t * (float) last;
+    int index = std::min((int) segment, last - 1);
+    float local = segment - (float) index;
+
+    auto keyframe = [&](int i) -> const CameraKeyframe & {
+        return mKeyframes[std::clamp(i, 0, last)];
+    };
+
+    auto catmull_rom = [local](const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2, const glm::vec3 &p3) {
+        float t2 = local * local;
+        float t3 = t2 * local;
+        return 0.5f * ((2.0f * p1) + (-p0 + p2) * local + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                       (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
+    };
+
+    glm::vec3 position = catmull_rom(keyframe(index - 1).position, keyframe(index).position,
+                                     keyframe(index + 1).position, keyframe(index + 2).position);
+    glm::vec3 target = catmull_rom(keyframe(index - 1).target, keyframe(index).target,
+                                   keyframe(index + 1).target, keyframe(index + 2).target);
+
+    return glm::lookAt(position, target, glm::vec3{0.0f, 1.0f, 0.0f});
+}
+
+double percentile_sorted(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+
+    //nearest rank, always returns a value that was actually measured
+    auto rank = (size_t) std::ceil(p / 100.0 * (double) sorted.size());
+    rank = std::clamp<size_t>(rank, 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+TimingSummary summarize_timings(std::vector<double> values) {
+    TimingSummary summary{};
+    if (values.empty()) {
+        return summary;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    summary.samples = (uint32_t) values.size();
+    summary.min = values.front();
+    summary.max = values.back();
+    summary.mean = std::accumulate(values.begin(), values.end(), 0.0) / (double) values.size();
+    summary.p50 = percentile_sorted(values, 50.0);
+    summary.p95 = percentile_sorted(values, 95.0);
+    summary.p99 = percentile_sorted(values, 99.0);
+
+    return summary;
+}
+
+void BenchmarkReport::add_frame(uint64_t frameNumber, double cpuMs, uint32_t drawCalls, uint64_t triangles) {
+    BenchmarkFrame frame;
+    frame.frameNumber = frameNumber;
+    frame.cpuMs = cpuMs;
+    frame.drawCalls = drawCalls;
+    frame.triangles = triangles;
+
+    mFrames.push_back(frame);
+}
+
+void BenchmarkReport::set_gpu_time(uint64_t frameNumber, double gpuMs) {
+    //frames are added in order, so the frame number is a sorted key
+    auto it = std::lower_bound(mFrames.begin(), mFrames.end(), frameNumber,
+                               [](const BenchmarkFrame &frame, uint64_t number) {
+                                   return frame.frameNumber < number;
+                               });
+
+    if (it != mFrames.end() && it->frameNumber == frameNumber) {
+        it->gpuMs = gpuMs;
+    }
+}
+
+TimingSummary BenchmarkReport::cpu_summary() const {
+    std::vector<double> values;
+    values.reserve(mFrames.size());
+    for (const BenchmarkFrame &frame: mFrames) {
+        values.push_back(frame.cpuMs);
+    }
+
+    return summarize_timings(std::move(values));
+}
+
+TimingSummary BenchmarkReport::gpu_summary() const {
+    std::vector<double> values;
+    values.reserve(mFrames.size());
+    for (const BenchmarkFrame &frame: mFrames) {
+        if (frame.gpuMs >= 0.0) {
+            values.push_back(frame.gpuMs);
+        }
+    }
+
+    return summarize_timings(std::move(values));
+}
+
+bool BenchmarkReport::write(const std::string &path) const {
+    if (std::filesystem::path(path).extension() == ".csv") {
+        return write_csv(path);
+    }
+
+    return write_json(path);
+}
+
+static nlohmann::json summary_to_json(const TimingSummary &summary) {
+    nlohmann::json json;
+    json["samples"] = summary.samples;
+    json["min"] = summary.min;
+    json["mean"] = summary.mean;
+    json["p50"] = summary.p50;
+    json["p95"] = summary.p95;
+    json["p99"] = summary.p99;
+    json["max"] = summary.max;
+    return json;
+}
+
+bool BenchmarkReport::write_json(const std::string &path) const {
+    nlohmann::json report;
+    report["device"] = mDeviceName;
+    report["mode"] = mMode;
+    report["width"] = mWidth;
+    report["height"] = mHeight;
+    report["warmup_frames"] = mWarmupFrames;
+    report["frames"] = mFrames.size();
+    report["cpu_ms"] = summary_to_json(cpu_summary());
+    report["gpu_ms"] = summary_to_json(gpu_summary());
+
+    //draw counts are the same every frame unless culling is involved, so report the per-frame maximum
+    uint32_t maxDrawCalls = 0;
+    uint64_t maxTriangles = 0;
+    for (const BenchmarkFrame &frame: mFrames) {
+        maxDrawCalls = std::max(maxDrawCalls, frame.drawCalls);
+        maxTriangles = std::max(maxTriangles, frame.triangles);
+    }
+    report["draw_calls"] = maxDrawCalls;
+    report["triangles"] = maxTriangles;
+
+    nlohmann::json frames = nlohmann::json::array();
+    for (const BenchmarkFrame &frame: mFrames) {
+        frames.push_back({
+                                 {"frame",     frame.frameNumber},
+                                 {"cpu_ms",    frame.cpuMs},
+                                 {"gpu_ms",    frame.gpuMs},
+                                 {"draws",     frame.drawCalls},
+                                 {"triangles", frame.triangles}
+                         });
+    }
+    report["per_frame"] = frames;
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        Log::error("Failed to open " + path + " for writing");
+        return false;
+    }
+
+    file << report.dump(4);
+    return true;
+}
+
+bool BenchmarkReport::write_csv(const std::string &path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        Log::error("Failed to open " + path + " for writing");
+        return false;
+    }
+
+    file << "frame,cpu_ms,gpu_ms,draws,triangles\n";
+    for (const BenchmarkFrame &frame: mFrames) {
+        file << frame.frameNumber << "," << frame.cpuMs << "," << frame.gpuMs << "," << frame.drawCalls << ","
+             << frame.triangles << "\n";
+    }
+
+    return true;
+}
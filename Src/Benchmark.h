@@ -0,0 +1,95 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+//options for a benchmark run, set from the command line
+struct BenchmarkConfig {
+    //frames rendered before recording starts, lets caches and clocks settle
+    uint32_t warmupFrames{60};
+    //frames that are recorded and reported
+    uint32_t frames{1000};
+    //.csv writes one row per frame, anything else writes json
+    std::string outputPath{"benchmark.json"};
+};
+
+struct CameraKeyframe {
+    glm::vec3 position;
+    glm::vec3 target;
+};
+
+//camera path sampled by a normalized time, so the same frame count always gives the same views
+class CameraPath {
+public:
+    //a loop around the default scene
+    static CameraPath default_flythrough();
+
+    void add_keyframe(const glm::vec3 &position, const glm::vec3 &target);
+
+    //t in [0, 1], keyframes are spaced evenly and interpolated with catmull-rom
+    glm::mat4 sample_view(float t) const;
+
+private:
+    std::vector<CameraKeyframe> mKeyframes;
+};
+
+struct BenchmarkFrame {
+    uint64_t frameNumber{0};
+    double cpuMs{0.0};
+    //negative until the GPU time for the frame has been read back, and if timestamps are unsupported
+    double gpuMs{-1.0};
+    uint32_t drawCalls{0};
+    uint64_t triangles{0};
+};
+
+struct TimingSummary {
+    uint32_t samples{0};
+    double min{0.0};
+    double mean{0.0};
+    double p50{0.0};
+    double p95{0.0};
+    double p99{0.0};
+    double max{0.0};
+};
+
+//collects per-frame samples and writes the report
+class BenchmarkReport {
+public:
+    void add_frame(uint64_t frameNumber, double cpuMs, uint32_t drawCalls, uint64_t triangles);
+
+    //GPU times arrive a few frames late, frames that were not recorded are ignored
+    void set_gpu_time(uint64_t frameNumber, double gpuMs);
+
+    TimingSummary cpu_summary() const;
+
+    TimingSummary gpu_summary() const;
+
+    //.csv gets one row per frame, anything else gets a json summary plus the per-frame samples
+    bool write(const std::string &path) const;
+
+    //device and run details that end up in the report header
+    std::string mDeviceName;
+    std::string mMode;
+    uint32_t mWidth{0};
+    uint32_t mHeight{0};
+    uint32_t mWarmupFrames{0};
+
+private:
+    bool write_json(const std::string &path) const;
+
+    bool write_csv(const std::string &path) const;
+
+    std::vector<BenchmarkFrame> mFrames;
+};
+
+//nearest-rank percentile over an already sorted list, p in [0, 100]
+double percentile_sorted(const std::vector<double> &sorted, double p);
+
+TimingSummary summarize_timings(std::vector<double> values);
@@ -0,0 +1,315 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "TransformSystem.h"
+#include "Tracy.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+
+#include <xmmintrin.h>
+
+#define TRANSFORM_SYSTEM_SSE 1
+#endif
+
+//below this many transforms waking the workers costs more than the matrix math
+static constexpr size_t PARALLEL_MIN_TRANSFORMS = 4096;
+//fewest ids a worker takes from a level at a time, wide levels are cut into a few chunks per worker
+static constexpr size_t MIN_WORKER_CHUNK = 64;
+
+//out = a * b. Each column of the result is the columns of a weighted by one column of b, four lanes at a time
+static void multiply(const glm::mat4 &a, const glm::mat4 &b, glm::mat4 &out) {
+#ifdef TRANSFORM_SYSTEM_SSE
+    const float *pa = &a[0][0];
+    const float *pb = &b[0][0];
+    float *po = &out[0][0];
+
+    __m128 a0 = _mm_loadu_ps(pa);
+    __m128 a1 = _mm_loadu_ps(pa + 4);
+    __m128 a2 = _mm_loadu_ps(pa + 8);
+    __m128 a3 = _mm_loadu_ps(pa + 12);
+
+    for (int column = 0; column < 4; column++) {
+        const float *bc = pb + column * 4;
+        __m128 result = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+        result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+        result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+        result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+        _mm_storeu_ps(po + column * 4, result);
+    }
+#else
+    out = a * b;
+#endif
+}
+
+//translate * rotate * scale without building and multiplying the three matrices
+static glm::mat4 compose(const glm::vec3 &translation, const glm::quat &rotation, const glm::vec3 &scale) {
+    glm::mat3 r = glm::mat3_cast(rotation);
+    return {glm::vec4(r[0] * scale.x, 0.0f),
+            glm::vec4(r[1] * scale.y, 0.0f),
+            glm::vec4(r[2] * scale.z, 0.0f),
+            glm::vec4(translation, 1.0f)};
+}
+
+TransformSystem::~TransformSystem() {
+    stop_workers();
+}
+
+void TransformSystem::set_consumer_count(uint32_t count) {
+    size_t oldCount = mConsumers.size();
+    mConsumers.resize(count);
+
+    for (size_t c = oldCount; c < mConsumers.size(); c++) {
+        Consumer &consumer = mConsumers[c];
+        consumer.queued.assign(mParents.size(), 1);
+        consumer.pending.resize(mParents.size());
+        for (TransformId id = 0; id < (TransformId) mParents.size(); id++) {
+            consumer.pending[id] = id;
+        }
+    }
+}
+
+TransformId TransformSystem::create(const glm::vec3 &translation, const glm::quat &rotation,
+                                    const glm::vec3 &scale, TransformId parent) {
+    auto id = (TransformId) mParents.size();
+
+    mTranslations.push_back(translation);
+    mRotations.push_back(rotation);
+    mScales.push_back(scale);
+    mParents.push_back(parent);
+    mWorld.emplace_back(1.0f);
+    mDirty.push_back(1);
+    mChanged.push_back(0);
+    mAnyDirty = true;
+
+    uint32_t depth = parent == INVALID_TRANSFORM ? 0 : mDepths[parent] + 1;
+    mDepths.push_back(depth);
+    if (mLevels.size() <= depth) {
+        mLevels.resize(depth + 1);
+    }
+    mLevels[depth].push_back(id);
+
+    for (Consumer &consumer: mConsumers) {
+        consumer.queued.push_back(0);
+    }
+    return id;
+}
+
+void TransformSystem::set_translation(TransformId id, const glm::vec3 &translation) {
+    mTranslations[id] = translation;
+    mark_dirty(id);
+}
+
+void TransformSystem::set_rotation(TransformId id, const glm::quat &rotation) {
+    mRotations[id] = rotation;
+    mark_dirty(id);
+}
+
+void TransformSystem::set_scale(TransformId id, const glm::vec3 &scale) {
+    mScales[id] = scale;
+    mark_dirty(id);
+}
+
+bool TransformSystem::set_parent(TransformId id, TransformId parent) {
+    for (TransformId p = parent; p != INVALID_TRANSFORM; p = mParents[p]) {
+        if (p == id) {
+            return false;
+        }
+    }
+    if (mParents[id] == parent) {
+        return true;
+    }
+    mParents[id] = parent;
+
+    //there are no child lists, but a child is always one level below its parent, so the levels under id are
+    //enough to find every descendant. They come out parents first
+    uint32_t oldDepth = mDepths[id];
+    std::vector<uint8_t> inSubtree(mParents.size(), 0);
+    std::vector<TransformId> subtree{id};
+    inSubtree[id] = 1;
+    for (size_t l = oldDepth + 1; l < mLevels.size(); l++) {
+        for (TransformId child: mLevels[l]) {
+            if (inSubtree[mParents[child]]) {
+                inSubtree[child] = 1;
+                subtree.push_back(child);
+            }
+        }
+    }
+
+    for (size_t l = oldDepth; l < mLevels.size(); l++) {
+        std::erase_if(mLevels[l], [&](TransformId t) { return inSubtree[t] != 0; });
+    }
+    for (TransformId t: subtree) {
+        uint32_t depth = mParents[t] == INVALID_TRANSFORM ? 0 : mDepths[mParents[t]] + 1;
+        mDepths[t] = depth;
+        if (mLevels.size() <= depth) {
+            mLevels.resize(depth + 1);
+        }
+        mLevels[depth].push_back(t);
+    }
+    while (!mLevels.empty() && mLevels.back().empty()) {
+        mLevels.pop_back();
+    }
+
+    //the descendants follow through mChanged
+    mark_dirty(id);
+    return true;
+}
+
+void TransformSystem::mark_dirty(TransformId id) {
+    mDirty[id] = 1;
+    mAnyDirty = true;
+}
+
+void TransformSystem::update_level(const TransformId *ids, size_t count, std::vector<TransformId> &changed) {
+    for (size_t i = 0; i < count; i++) {
+        TransformId id = ids[i];
+        TransformId parent = mParents[id];
+
+        bool parentChanged = parent != INVALID_TRANSFORM && mChanged[parent];
+        mChanged[id] = mDirty[id] | parentChanged;
+        if (!mChanged[id]) {
+            continue;
+        }
+
+        glm::mat4 local = compose(mTranslations[id], mRotations[id], mScales[id]);
+        if (parent == INVALID_TRANSFORM) {
+            mWorld[id] = local;
+        } else {
+            multiply(mWorld[parent], local, mWorld[id]);
+        }
+
+        mDirty[id] = 0;
+        changed.push_back(id);
+    }
+}
+
+uint32_t TransformSystem::update(uint32_t threadCount) {
+    ZoneScopedN("Update Transforms")
+
+    if (!mAnyDirty) {
+        return 0;
+    }
+    mAnyDirty = false;
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    if (threadCount <= 1 || mParents.size() < PARALLEL_MIN_TRANSFORMS) {
+        std::vector<TransformId> changed;
+        for (const std::vector<TransformId> &level: mLevels) {
+            update_level(level.data(), level.size(), changed);
+        }
+        queue_changed(changed);
+        return (uint32_t) changed.size();
+    }
+
+    start_workers(threadCount);
+
+    if (mCursorCount < mLevels.size()) {
+        mCursorCount = mLevels.size();
+        mCursors = std::make_unique<std::atomic<size_t>[]>(mCursorCount);
+    }
+    for (size_t l = 0; l < mLevels.size(); l++) {
+        mCursors[l].store(0, std::memory_order_relaxed);
+    }
+    for (std::vector<TransformId> &changed: mChangedPerWorker) {
+        changed.clear();
+    }
+
+    //the workers take the generation under the lock, which also makes the reset above visible to them
+    {
+        std::lock_guard<std::mutex> lock(mWorkMutex);
+        mGeneration++;
+    }
+    mWorkReady.notify_all();
+    run_levels(0);
+
+    //every worker has passed the barrier after the last level, so all they wrote is visible here
+    uint32_t changedCount = 0;
+    for (const std::vector<TransformId> &changed: mChangedPerWorker) {
+        queue_changed(changed);
+        changedCount += (uint32_t) changed.size();
+    }
+    return changedCount;
+}
+
+void TransformSystem::run_levels(uint32_t workerIndex) {
+    std::vector<TransformId> &changed = mChangedPerWorker[workerIndex];
+    //read once, the caller is free to change the levels as soon as the last barrier lets it go
+    size_t levelCount = mLevels.size();
+    for (size_t l = 0; l < levelCount; l++) {
+        const std::vector<TransformId> &level = mLevels[l];
+        size_t chunk = std::max(MIN_WORKER_CHUNK, level.size() / (mWorkerCount * 4));
+        size_t start;
+        while ((start = mCursors[l].fetch_add(chunk, std::memory_order_relaxed)) < level.size()) {
+            update_level(level.data() + start, std::min(chunk, level.size() - start), changed);
+        }
+        //the next level reads the matrices this one wrote
+        mLevelDone->arrive_and_wait();
+    }
+}
+
+void TransformSystem::worker_thread(uint32_t workerIndex, uint64_t generation) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mWorkMutex);
+            mWorkReady.wait(lock, [&] { return mStopping || mGeneration != generation; });
+            if (mStopping) {
+                return;
+            }
+            generation = mGeneration;
+        }
+        run_levels(workerIndex);
+    }
+}
+
+void TransformSystem::start_workers(uint32_t threadCount) {
+    if (threadCount == mWorkerCount) {
+        return;
+    }
+    stop_workers();
+
+    mWorkerCount = threadCount;
+    mLevelDone = std::make_unique<std::barrier<>>((std::ptrdiff_t) threadCount);
+    mChangedPerWorker.resize(threadCount);
+    mStopping = false;
+    for (uint32_t i = 1; i < threadCount; i++) {
+        mWorkers.emplace_back(&TransformSystem::worker_thread, this, i, mGeneration);
+    }
+}
+
+void TransformSystem::stop_workers() {
+    {
+        std::lock_guard<std::mutex> lock(mWorkMutex);
+        mStopping = true;
+    }
+    mWorkReady.notify_all();
+    for (std::thread &worker: mWorkers) {
+        worker.join();
+    }
+    mWorkers.clear();
+    mWorkerCount = 0;
+}
+
+void TransformSystem::queue_changed(const std::vector<TransformId> &changed) {
+    for (Consumer &consumer: mConsumers) {
+        for (TransformId id: changed) {
+            if (!consumer.queued[id]) {
+                consumer.queued[id] = 1;
+                consumer.pending.push_back(id);
+            }
+        }
+    }
+}
+
+void TransformSystem::clear_pending(uint32_t consumer) {
+    Consumer &c = mConsumers[consumer];
+    for (TransformId id: c.pending) {
+        c.queued[id] = 0;
+    }
+    c.pending.clear();
+}
@@ -0,0 +1,137 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <atomic>
+#include <barrier>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using TransformId = uint32_t;
+constexpr TransformId INVALID_TRANSFORM = UINT32_MAX;
+
+//local translation, rotation and scale of every object, with optional parents, turned into world matrices.
+//setters only flag a transform dirty. update recomputes the dirty ones and everything below them one level of the
+//hierarchy at a time, so each level can be split over threads, which are started on the first large update and
+//kept for the next ones.
+//
+//consumers are copies of the world matrices kept elsewhere, like the object buffer of each frame in flight. A change
+//stays queued for every consumer until that consumer clears it, so each copy is only sent the matrices it is missing
+class TransformSystem {
+public:
+    TransformSystem() = default;
+
+    TransformSystem(const TransformSystem &) = delete;
+
+    TransformSystem &operator=(const TransformSystem &) = delete;
+
+    //stops the worker threads
+    ~TransformSystem();
+
+    //new consumers start with every existing transform queued
+    void set_consumer_count(uint32_t count);
+
+    TransformId create(const glm::vec3 &translation = glm::vec3{0.0f},
+                       const glm::quat &rotation = glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                       const glm::vec3 &scale = glm::vec3{1.0f}, TransformId parent = INVALID_TRANSFORM);
+
+    void set_translation(TransformId id, const glm::vec3 &translation);
+
+    void set_rotation(TransformId id, const glm::quat &rotation);
+
+    void set_scale(TransformId id, const glm::vec3 &scale);
+
+    //moves id and everything below it under parent, or makes it a root with INVALID_TRANSFORM. The local transform
+    //is kept, so the world matrix changes at the next update. Walks every transform below the old depth of id.
+    //Returns false and changes nothing if parent is id or one of its descendants
+    bool set_parent(TransformId id, TransformId parent);
+
+    const glm::vec3 &get_translation(TransformId id) const { return mTranslations[id]; }
+
+    const glm::quat &get_rotation(TransformId id) const { return mRotations[id]; }
+
+    const glm::vec3 &get_scale(TransformId id) const { return mScales[id]; }
+
+    TransformId get_parent(TransformId id) const { return mParents[id]; }
+
+    //as of the last update
+    const glm::mat4 &get_world(TransformId id) const { return mWorld[id]; }
+
+    //recomputes the world matrices of dirty transforms and their descendants and queues them for every consumer.
+    //threadCount 0 uses every core, small updates stay on the calling thread. Returns how many matrices changed
+    uint32_t update(uint32_t threadCount = 0);
+
+    //ids whose world matrix changed since the consumer last cleared, each listed once
+    const std::vector<TransformId> &get_pending(uint32_t consumer) const { return mConsumers[consumer].pending; }
+
+    void clear_pending(uint32_t consumer);
+
+    uint32_t get_count() const { return (uint32_t) mParents.size(); }
+
+private:
+    void mark_dirty(TransformId id);
+
+    //updates ids of one level, appending the ones that changed to changed
+    void update_level(const TransformId *ids, size_t count, std::vector<TransformId> &changed);
+
+    void queue_changed(const std::vector<TransformId> &changed);
+
+    //(re)starts the pool when the requested thread count differs from the running one
+    void start_workers(uint32_t threadCount);
+
+    void stop_workers();
+
+    //walks the levels taking chunks of each, waiting at the barrier for the other threads after each level
+    void run_levels(uint32_t workerIndex);
+
+    //generation is mGeneration when the thread was started, it runs an update each time that changes
+    void worker_thread(uint32_t workerIndex, uint64_t generation);
+
+    //local transform, one array per component so an update streams through memory
+    std::vector<glm::vec3> mTranslations;
+    std::vector<glm::quat> mRotations;
+    std::vector<glm::vec3> mScales;
+    std::vector<TransformId> mParents;
+
+    std::vector<glm::mat4> mWorld;
+
+    //set when the local transform changed since the last update
+    std::vector<uint8_t> mDirty;
+    //set when the last update recomputed the world matrix, children check their parent's
+    std::vector<uint8_t> mChanged;
+    bool mAnyDirty{false};
+
+    //ids by depth in the hierarchy, the roots are level 0
+    std::vector<std::vector<TransformId>> mLevels;
+    std::vector<uint32_t> mDepths;
+
+    struct Consumer {
+        std::vector<TransformId> pending;
+        //one flag per transform, so an id is only queued once however often it changes
+        std::vector<uint8_t> queued;
+    };
+    std::vector<Consumer> mConsumers;
+
+    //threads taking part in a parallel update, the calling thread is worker 0 and isn't in mWorkers
+    uint32_t mWorkerCount{0};
+    std::vector<std::thread> mWorkers;
+    std::unique_ptr<std::barrier<>> mLevelDone;
+    //bumped to start the workers on an update, they wait on mWorkReady for it to change
+    uint64_t mGeneration{0};
+    bool mStopping{false};
+    std::mutex mWorkMutex;
+    std::condition_variable mWorkReady;
+    //state of the running update, next id to take from each level and what each worker changed
+    std::unique_ptr<std::atomic<size_t>[]> mCursors;
+    size_t mCursorCount{0};
+    std::vector<std::vector<TransformId>> mChangedPerWorker;
+};
@@ -1,10 +1,57 @@
 #include "VulkanEngine.h"
 
+#include <cstring>
+#include <cstdlib>
+
 int main(int argc, char *args[]) {
+    EngineConfig config{};
+    BenchmarkConfig benchmarkConfig{};
+    bool runBenchmark = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(args[i], "--frames-in-flight") == 0 && i + 1 < argc) {
+            config.framesInFlight = (uint32_t) std::strtoul(args[++i], nullptr, 10);
+        } else if (strcmp(args[i], "--present-mode") == 0 && i + 1 < argc) {
+            const char *mode = args[++i];
+            if (strcmp(mode, "fifo") == 0) config.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+            else if (strcmp(mode, "fifo_relaxed") == 0) config.presentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+            else if (strcmp(mode, "mailbox") == 0) config.presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+            else if (strcmp(mode, "immediate") == 0) config.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+        } else if (strcmp(args[i], "--headless") == 0) {
+            config.headless = true;
+        } else if (strcmp(args[i], "--frames") == 0 && i + 1 < argc) {
+            config.headlessFrames = (uint32_t) std::strtoul(args[++i], nullptr, 10);
+        } else if (strcmp(args[i], "--dump") == 0 && i + 1 < argc) {
+            config.headlessDumpPath = args[++i];
+        } else if (strcmp(args[i], "--benchmark") == 0) {
+            runBenchmark = true;
+        } else if (strcmp(args[i], "--benchmark-frames") == 0 && i + 1 < argc) {
+            benchmarkConfig.frames = (uint32_t) std::strtoul(args[++i], nullptr, 10);
+        } else if (strcmp(args[i], "--benchmark-warmup") == 0 && i + 1 < argc) {
+            benchmarkConfig.warmupFrames = (uint32_t) std::strtoul(args[++i], nullptr, 10);
+        } else if (strcmp(args[i], "--benchmark-output") == 0 && i + 1 < argc) {
+            benchmarkConfig.outputPath = args[++i];
+        } else if (strcmp(args[i], "--width") == 0 && i + 1 < argc) {
+            config.extent.width = (uint32_t) std::strtoul(args[++i], nullptr, 10);
+        } else if (strcmp(args[i], "--height") == 0 && i + 1 < argc) {
+            config.extent.height = (uint32_t) std::strtoul(args[++i], nullptr, 10);
+        } else if (strcmp(args[i], "--texture-budget-mb") == 0 && i + 1 < argc) {
+            config.textureStreaming.budgetBytes = std::strtoull(args[++i], nullptr, 10) * 1024 * 1024;
+        } else if (strcmp(args[i], "--no-shader-reload") == 0) {
+            config.shaderHotReload = false;
+        }
+    }
+
     VulkanEngine engine;
 
-    engine.init();
-    engine.run();
+    if (!engine.init(config)) {
+        return EXIT_FAILURE;
+    }
+    if (runBenchmark) {
+        engine.run_benchmark(benchmarkConfig);
+    } else {
+        engine.run();
+    }
     engine.cleanup();
 
     return 0;
@@ -0,0 +1,322 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "TestHarness.h"
+
+#include "asset_loader.h"
+#include "block_compression.h"
+#include "mip_generation.h"
+#include "texture_asset.h"
+
+#include "lz4.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+//gradients with a little noise, compresses under LZ4 and block compresses with some but not much error
+static std::vector<uint8_t> make_image(uint32_t width, uint32_t height) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> noise(0, 3);
+
+    std::vector<uint8_t> pixels(size_t(width) * height * 4);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            uint8_t *p = &pixels[(size_t(y) * width + x) * 4];
+            p[0] = uint8_t(x * 255 / width + noise(rng));
+            p[1] = uint8_t(y * 255 / height);
+            p[2] = uint8_t((x + y) * 127 / (width + height) + 64);
+            p[3] = uint8_t(255 - x * 128 / width);
+        }
+    }
+    return pixels;
+}
+
+static std::vector<char> make_compressible(size_t size) {
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = char((i / 64) % 17 + (i % 3));
+    }
+    return data;
+}
+
+static bool lz4_round_trip(const char *compressed, size_t compressedSize, const std::vector<char> &original) {
+    std::vector<char> decompressed(original.size());
+    int size = LZ4_decompress_safe(compressed, decompressed.data(), (int) compressedSize, (int) decompressed.size());
+    return size == (int) original.size() && decompressed == original;
+}
+
+SLIME_TEST("assets/lz4_round_trip", [](TestContext &t) {
+    std::vector<char> source = make_compressible(256 * 1024);
+
+    for (assets::CompressionCodec codec: {assets::CompressionCodec::LZ4, assets::CompressionCodec::LZ4HC}) {
+        assets::CompressionSettings settings;
+        settings.codec = codec;
+
+        //compress_block appends, what is already in the destination has to survive
+        std::vector<char> destination(16, 'x');
+        size_t written = assets::compress_block(settings, source.data(), source.size(), destination);
+
+        SLIME_CHECK(t, written < source.size());
+        SLIME_CHECK(t, destination.size() == 16 + written);
+        SLIME_CHECK(t, std::all_of(destination.begin(), destination.begin() + 16, [](char c) { return c == 'x'; }));
+        SLIME_CHECK(t, lz4_round_trip(destination.data() + 16, written, source));
+    }
+});
+
+SLIME_TEST("assets/lz4_incompressible_stored_raw", [](TestContext &t) {
+    std::mt19937 rng(11);
+    std::vector<char> source(64 * 1024);
+    for (char &c: source) {
+        c = char(rng());
+    }
+
+    for (assets::CompressionCodec codec: {assets::CompressionCodec::LZ4, assets::CompressionCodec::LZ4HC}) {
+        assets::CompressionSettings settings;
+        settings.codec = codec;
+
+        std::vector<char> destination;
+        size_t written = assets::compress_block(settings, source.data(), source.size(), destination);
+
+        //returning the source size is how callers tell a raw block from a compressed one
+        SLIME_CHECK(t, written == source.size());
+        SLIME_CHECK(t, destination == source);
+    }
+
+    //a ratio no block can reach keeps even compressible data raw
+    std::vector<char> compressible = make_compressible(64 * 1024);
+    assets::CompressionSettings strict;
+    strict.maxRatio = 0.0f;
+    std::vector<char> destination;
+    SLIME_CHECK(t, assets::compress_block(strict, compressible.data(), compressible.size(), destination) ==
+                   compressible.size());
+    SLIME_CHECK(t, destination == compressible);
+
+    assets::CompressionSettings none;
+    none.codec = assets::CompressionCodec::None;
+    destination.clear();
+    SLIME_CHECK(t, assets::compress_block(none, compressible.data(), compressible.size(), destination) ==
+                   compressible.size());
+    SLIME_CHECK(t, destination == compressible);
+});
+
+//reference decoders, written from the format specs and not from the encoder
+
+static void unpack_565(uint16_t packed, int colour[3]) {
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    colour[0] = (r << 3) | (r >> 2);
+    colour[1] = (g << 2) | (g >> 4);
+    colour[2] = (b << 3) | (b >> 2);
+}
+
+static void decode_bc1_block(const uint8_t *block, uint8_t *pixels) {
+    uint16_t c0 = uint16_t(block[0] | block[1] << 8);
+    uint16_t c1 = uint16_t(block[2] | block[3] << 8);
+
+    int palette[4][4];
+    unpack_565(c0, palette[0]);
+    unpack_565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = 255;
+    for (int c = 0; c < 3; c++) {
+        if (c0 > c1) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = c0 > c1 ? 255 : 0;
+
+    uint32_t indices;
+    memcpy(&indices, block + 4, 4);
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            pixels[i * 4 + c] = uint8_t(palette[(indices >> (i * 2)) & 3][c]);
+        }
+    }
+}
+
+static uint32_t read_bits(const uint8_t *block, uint32_t &position, uint32_t count) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < count; i++, position++) {
+        if (block[position / 8] & (1u << (position % 8))) {
+            value |= 1u << i;
+        }
+    }
+    return value;
+}
+
+//mode 6 only, the encoder writes no other mode. Returns false for anything else
+static bool decode_bc7_block(const uint8_t *block, uint8_t *pixels) {
+    static const int weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    uint32_t position = 0;
+    if (read_bits(block, position, 7) != 1u << 6) {
+        return false;
+    }
+
+    int endpoints[2][4];
+    for (int c = 0; c < 4; c++) {
+        endpoints[0][c] = (int) read_bits(block, position, 7);
+        endpoints[1][c] = (int) read_bits(block, position, 7);
+    }
+    int pbit0 = (int) read_bits(block, position, 1);
+    int pbit1 = (int) read_bits(block, position, 1);
+
+    for (int i = 0; i < 16; i++) {
+        int index = (int) read_bits(block, position, i == 0 ? 3 : 4);
+        for (int c = 0; c < 4; c++) {
+            int e0 = (endpoints[0][c] << 1) | pbit0;
+            int e1 = (endpoints[1][c] << 1) | pbit1;
+            pixels[i * 4 + c] = uint8_t(((64 - weights[index]) * e0 + weights[index] * e1 + 32) >> 6);
+        }
+    }
+    return true;
+}
+
+struct BlockError {
+    double rmse{0.0};
+    int maxError{0};
+    bool decoded{true};
+};
+
+//encodes the whole image, decodes it block by block and compares the first channels of every texel
+static BlockError block_error(assets::TextureFormat format, const std::vector<uint8_t> &image, uint32_t width,
+                              uint32_t height, int channels) {
+    std::vector<char> encoded = assets::encode_blocks(format, image.data(), width, height);
+    uint32_t blockBytes = assets::texture_block_size(format);
+
+    BlockError result;
+    double squared = 0.0;
+    uint32_t blocksX = width / 4;
+    for (uint32_t by = 0; by < height / 4; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            const auto *block = (const uint8_t *) encoded.data() + (size_t(by) * blocksX + bx) * blockBytes;
+            uint8_t decoded[64];
+            if (format == assets::TextureFormat::BC1) {
+                decode_bc1_block(block, decoded);
+            } else {
+                result.decoded &= decode_bc7_block(block, decoded);
+            }
+
+            for (uint32_t i = 0; i < 16; i++) {
+                const uint8_t *original = &image[((size_t(by) * 4 + i / 4) * width + bx * 4 + i % 4) * 4];
+                for (int c = 0; c < channels; c++) {
+                    int error = std::abs(int(original[c]) - int(decoded[i * 4 + c]));
+                    squared += double(error * error);
+                    result.maxError = std::max(result.maxError, error);
+                }
+            }
+        }
+    }
+    result.rmse = std::sqrt(squared / (double(width) * height * channels));
+    return result;
+}
+
+SLIME_TEST("assets/bc1_error_bound", [](TestContext &t) {
+    std::vector<uint8_t> image = make_image(64, 64);
+    SLIME_CHECK(t, assets::encode_blocks(assets::TextureFormat::BC1, image.data(), 64, 64).size() == 16 * 16 * 8);
+
+    //RGB only, BC1 keeps no alpha besides the cut-out bit. The encoder gets about 3.1 and 13 on this image, a
+    //broken endpoint fit or index search is far past these
+    BlockError error = block_error(assets::TextureFormat::BC1, image, 64, 64, 3);
+    SLIME_CHECK_LE(t, error.rmse, 4.0);
+    SLIME_CHECK_LE(t, error.maxError, 20);
+
+    //texels under half alpha come back fully transparent, the others opaque
+    uint8_t pixels[64];
+    for (int i = 0; i < 16; i++) {
+        pixels[i * 4 + 0] = uint8_t(i * 16);
+        pixels[i * 4 + 1] = 200;
+        pixels[i * 4 + 2] = 50;
+        pixels[i * 4 + 3] = i % 2 == 0 ? 0 : 255;
+    }
+    uint8_t block[8];
+    assets::encode_bc1_block(pixels, block);
+    uint8_t decoded[64];
+    decode_bc1_block(block, decoded);
+    for (int i = 0; i < 16; i++) {
+        SLIME_CHECK(t, decoded[i * 4 + 3] == (i % 2 == 0 ? 0 : 255));
+    }
+});
+
+SLIME_TEST("assets/bc7_error_bound", [](TestContext &t) {
+    std::vector<uint8_t> image = make_image(64, 64);
+    SLIME_CHECK(t, assets::encode_blocks(assets::TextureFormat::BC7, image.data(), 64, 64).size() == 16 * 16 * 16);
+
+    //about 2.3 and 9 with mode 6 alone
+    BlockError error = block_error(assets::TextureFormat::BC7, image, 64, 64, 4);
+    SLIME_CHECK(t, error.decoded);
+    SLIME_CHECK_LE(t, error.rmse, 3.0);
+    SLIME_CHECK_LE(t, error.maxError, 12);
+
+    //a solid block only has the endpoint quantization to lose
+    uint8_t pixels[64];
+    for (int i = 0; i < 16; i++) {
+        pixels[i * 4 + 0] = 10;
+        pixels[i * 4 + 1] = 128;
+        pixels[i * 4 + 2] = 201;
+        pixels[i * 4 + 3] = 77;
+    }
+    uint8_t block[16];
+    assets::encode_bc7_block(pixels, block);
+    uint8_t decoded[64];
+    SLIME_CHECK(t, decode_bc7_block(block, decoded));
+    for (int i = 0; i < 64; i++) {
+        SLIME_CHECK_LE(t, std::abs(int(decoded[i]) - int(pixels[i])), 1);
+    }
+});
+
+SLIME_TEST("assets/mip_chain_sizes", [](TestContext &t) {
+    //odd sizes round down, and the shorter side stops at 1 while the longer one keeps halving
+    struct Case {
+        uint32_t width;
+        uint32_t height;
+        std::vector<std::pair<uint32_t, uint32_t>> levels;
+    };
+    std::vector<Case> cases = {
+            {256, 64, {{256, 64}, {128, 32}, {64, 16}, {32, 8}, {16, 4}, {8, 2}, {4, 1}, {2, 1}, {1, 1}}},
+            {100, 37, {{100, 37}, {50, 18}, {25, 9}, {12, 4}, {6, 2}, {3, 1}, {1, 1}}},
+            {1, 1, {{1, 1}}},
+    };
+
+    for (const Case &c: cases) {
+        std::vector<uint8_t> image = make_image(c.width, c.height);
+        for (assets::MipFilter filter: {assets::MipFilter::Box, assets::MipFilter::Kaiser}) {
+            std::vector<assets::MipLevel> levels = assets::generate_mips(image.data(), c.width, c.height, filter,
+                                                                         true);
+
+            SLIME_CHECK(t, levels.size() == c.levels.size());
+            for (size_t l = 0; l < std::min(levels.size(), c.levels.size()); l++) {
+                SLIME_CHECK(t, levels[l].width == c.levels[l].first);
+                SLIME_CHECK(t, levels[l].height == c.levels[l].second);
+                SLIME_CHECK(t, levels[l].pixels.size() == size_t(levels[l].width) * levels[l].height * 4);
+            }
+            SLIME_CHECK(t, !levels.empty() && levels[0].pixels == image);
+        }
+    }
+
+    //a flat image stays flat at every level, the filters sum to one in both colour spaces
+    std::vector<uint8_t> flat(64 * 32 * 4);
+    for (size_t i = 0; i < flat.size(); i += 4) {
+        flat[i + 0] = 200;
+        flat[i + 1] = 100;
+        flat[i + 2] = 30;
+        flat[i + 3] = 255;
+    }
+    for (assets::MipFilter filter: {assets::MipFilter::Box, assets::MipFilter::Kaiser}) {
+        for (bool srgb: {false, true}) {
+            for (const assets::MipLevel &level: assets::generate_mips(flat.data(), 64, 32, filter, srgb)) {
+                for (size_t i = 0; i < level.pixels.size(); i++) {
+                    SLIME_CHECK_LE(t, std::abs(int(level.pixels[i]) - int(flat[i % 4])), 1);
+                }
+            }
+        }
+    }
+});
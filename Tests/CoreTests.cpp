@@ -0,0 +1,153 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "TestHarness.h"
+
+#include "TransformSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+
+static float max_difference(const glm::mat4 &a, const glm::mat4 &b) {
+    float difference = 0.0f;
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            difference = std::max(difference, std::abs(a[column][row] - b[column][row]));
+        }
+    }
+    return difference;
+}
+
+static float max_difference(const glm::vec4 &a, const glm::vec4 &b) {
+    float difference = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        difference = std::max(difference, std::abs(a[i] - b[i]));
+    }
+    return difference;
+}
+
+static glm::mat4 translation(float x, float y, float z) {
+    glm::mat4 result(1.0f);
+    result[3] = glm::vec4(x, y, z, 1.0f);
+    return result;
+}
+
+static glm::mat4 local_matrix(const TransformSystem &transforms, TransformId id) {
+    glm::mat3 r = glm::mat3_cast(transforms.get_rotation(id));
+    const glm::vec3 &s = transforms.get_scale(id);
+    return {glm::vec4(r[0] * s.x, 0.0f), glm::vec4(r[1] * s.y, 0.0f), glm::vec4(r[2] * s.z, 0.0f),
+            glm::vec4(transforms.get_translation(id), 1.0f)};
+}
+
+//walks the parents and multiplies the local matrices, the slow way update has to agree with
+static glm::mat4 reference_world(const TransformSystem &transforms, TransformId id) {
+    glm::mat4 world = local_matrix(transforms, id);
+    for (TransformId p = transforms.get_parent(id); p != INVALID_TRANSFORM; p = transforms.get_parent(p)) {
+        world = local_matrix(transforms, p) * world;
+    }
+    return world;
+}
+
+SLIME_TEST("core/transform_reparent", [](TestContext &t) {
+    TransformSystem transforms;
+    transforms.set_consumer_count(1);
+
+    //a quarter turn about z maps the child's +x offset onto +y
+    glm::quat quarterTurn = glm::angleAxis(std::numbers::pi_v<float> / 2.0f, glm::vec3{0.0f, 0.0f, 1.0f});
+    TransformId root = transforms.create(glm::vec3{1.0f, 2.0f, 3.0f}, quarterTurn);
+    TransformId otherRoot = transforms.create(glm::vec3{10.0f, 0.0f, 0.0f});
+    TransformId child = transforms.create(glm::vec3{1.0f, 0.0f, 0.0f}, glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                                          glm::vec3{1.0f}, root);
+    TransformId grandchild = transforms.create(glm::vec3{0.0f, 0.0f, 5.0f}, glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                                               glm::vec3{1.0f}, child);
+
+    SLIME_CHECK(t, transforms.update(1) == 4);
+    SLIME_CHECK_LE(t, max_difference(transforms.get_world(child), reference_world(transforms, child)), 1e-5f);
+    SLIME_CHECK_LE(t, max_difference(transforms.get_world(grandchild)[3], glm::vec4{1.0f, 3.0f, 8.0f, 1.0f}), 1e-5f);
+    transforms.clear_pending(0);
+
+    //the grandchild comes along and both are recomputed, nothing else is
+    SLIME_CHECK(t, transforms.set_parent(child, otherRoot));
+    SLIME_CHECK(t, transforms.get_parent(child) == otherRoot);
+    SLIME_CHECK(t, transforms.update(1) == 2);
+    SLIME_CHECK(t, transforms.get_pending(0).size() == 2);
+    SLIME_CHECK_LE(t, max_difference(transforms.get_world(child), translation(11.0f, 0.0f, 0.0f)), 1e-5f);
+    SLIME_CHECK_LE(t, max_difference(transforms.get_world(grandchild), translation(11.0f, 0.0f, 5.0f)), 1e-5f);
+
+    //moving the new parent moves them, moving the old one doesn't
+    transforms.set_translation(otherRoot, glm::vec3{20.0f, 0.0f, 0.0f});
+    transforms.set_translation(root, glm::vec3{-1.0f, -1.0f, -1.0f});
+    transforms.update(1);
+    SLIME_CHECK_LE(t, max_difference(transforms.get_world(grandchild), translation(21.0f, 0.0f, 5.0f)), 1e-5f);
+
+    SLIME_CHECK(t, transforms.set_parent(child, INVALID_TRANSFORM));
+    transforms.update(1);
+    SLIME_CHECK_LE(t, max_difference(transforms.get_world(grandchild), translation(1.0f, 0.0f, 5.0f)), 1e-5f);
+
+    //a grandchild created before its new parent still updates after it
+    TransformId late = transforms.create(glm::vec3{0.0f, 3.0f, 0.0f});
+    SLIME_CHECK(t, transforms.set_parent(grandchild, late));
+    transforms.update(1);
+    SLIME_CHECK_LE(t, max_difference(transforms.get_world(grandchild), translation(0.0f, 3.0f, 5.0f)), 1e-5f);
+
+    //a root and its child moved under the deepest transform update after it, two levels further down than before
+    TransformId branch = transforms.create(glm::vec3{0.0f, 0.0f, 1.0f});
+    TransformId leaf = transforms.create(glm::vec3{2.0f, 0.0f, 0.0f}, glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+                                         glm::vec3{1.0f}, branch);
+    transforms.update(1);
+    SLIME_CHECK(t, transforms.set_parent(branch, grandchild));
+    transforms.set_translation(late, glm::vec3{0.0f, 4.0f, 0.0f});
+    transforms.update(1);
+    SLIME_CHECK_LE(t, max_difference(transforms.get_world(leaf), translation(2.0f, 4.0f, 6.0f)), 1e-5f);
+
+    //cycles are refused and leave the hierarchy alone
+    SLIME_CHECK(t, !transforms.set_parent(late, grandchild));
+    SLIME_CHECK(t, !transforms.set_parent(child, child));
+    SLIME_CHECK(t, transforms.get_parent(late) == INVALID_TRANSFORM);
+});
+
+SLIME_TEST("core/transform_parallel_update", [](TestContext &t) {
+    //large enough for update to use its worker threads, compared against the single threaded result
+    constexpr uint32_t COUNT = 20000;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+
+    TransformSystem parallel;
+    TransformSystem serial;
+    for (uint32_t i = 0; i < COUNT; i++) {
+        glm::vec3 position{offset(rng), offset(rng), offset(rng)};
+        glm::quat rotation = glm::angleAxis(offset(rng), glm::vec3{0.0f, 0.0f, 1.0f});
+        TransformId parent = i < 64 ? INVALID_TRANSFORM : TransformId(rng() % i);
+        parallel.create(position, rotation, glm::vec3{1.0f}, parent);
+        serial.create(position, rotation, glm::vec3{1.0f}, parent);
+    }
+
+    bool matches = true;
+    for (uint32_t frame = 0; frame < 8; frame++) {
+        for (uint32_t i = 0; i < 100; i++) {
+            auto id = TransformId(rng() % COUNT);
+            glm::vec3 position{offset(rng), offset(rng), offset(rng)};
+            parallel.set_translation(id, position);
+            serial.set_translation(id, position);
+        }
+        for (uint32_t i = 0; i < 10; i++) {
+            auto id = TransformId(rng() % COUNT);
+            TransformId parent = rng() % 4 == 0 ? INVALID_TRANSFORM : TransformId(rng() % COUNT);
+            SLIME_CHECK(t, parallel.set_parent(id, parent) == serial.set_parent(id, parent));
+        }
+
+        //switching the thread count restarts the workers
+        SLIME_CHECK(t, parallel.update(frame < 4 ? 4 : 3) == serial.update(1));
+        for (TransformId id = 0; id < COUNT; id++) {
+            matches &= max_difference(parallel.get_world(id), serial.get_world(id)) <= 1e-4f;
+        }
+    }
+    SLIME_CHECK(t, matches);
+
+    for (TransformId id = 0; id < COUNT; id++) {
+        SLIME_CHECK_LE(t, max_difference(serial.get_world(id), reference_world(serial, id)), 1e-3f);
+    }
+});
@@ -0,0 +1,85 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "TestHarness.h"
+
+#include "VulkanHash.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+static VkDescriptorSetLayoutBinding make_binding(uint32_t binding, VkDescriptorType type, VkShaderStageFlags stages,
+                                                 uint32_t count = 1) {
+    VkDescriptorSetLayoutBinding result{};
+    result.binding = binding;
+    result.descriptorType = type;
+    result.descriptorCount = count;
+    result.stageFlags = stages;
+    return result;
+}
+
+static uint64_t hash_bindings(const std::vector<VkDescriptorSetLayoutBinding> &bindings,
+                              VkDescriptorSetLayoutCreateFlags flags = 0) {
+    return vkutil::hash_descriptor_bindings(bindings.data(), (uint32_t) bindings.size(), flags);
+}
+
+SLIME_TEST("descriptors/hash_permutations", [](TestContext &t) {
+    //bindings are hashed in order, an XOR of per-binding hashes would give every ordering the same value
+    std::vector<VkDescriptorSetLayoutBinding> bindings = {
+            make_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT),
+            make_binding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT),
+            make_binding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT),
+            make_binding(3, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_FRAGMENT_BIT),
+            make_binding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+
+    std::vector<size_t> order = {0, 1, 2, 3, 4};
+    std::unordered_set<uint64_t> hashes;
+    size_t permutations = 0;
+    do {
+        std::vector<VkDescriptorSetLayoutBinding> permuted;
+        for (size_t i: order) {
+            permuted.push_back(bindings[i]);
+        }
+        hashes.insert(hash_bindings(permuted));
+        permutations++;
+    } while (std::next_permutation(order.begin(), order.end()));
+
+    SLIME_CHECK(t, permutations == 120);
+    SLIME_CHECK(t, hashes.size() == permutations);
+});
+
+SLIME_TEST("descriptors/hash_fields", [](TestContext &t) {
+    std::vector<VkDescriptorSetLayoutBinding> base = {
+            make_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT),
+            make_binding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 4),
+    };
+    uint64_t baseHash = hash_bindings(base);
+    SLIME_CHECK(t, hash_bindings(base) == baseHash);
+
+    //each layout differs from the base in exactly one field
+    std::vector<uint64_t> hashes = {baseHash};
+    auto changed = [&](auto edit) {
+        std::vector<VkDescriptorSetLayoutBinding> bindings = base;
+        edit(bindings);
+        hashes.push_back(hash_bindings(bindings));
+    };
+    changed([](auto &b) { b[1].binding = 2; });
+    changed([](auto &b) { b[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE; });
+    changed([](auto &b) { b[1].descriptorCount = 5; });
+    changed([](auto &b) { b[1].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT; });
+    changed([](auto &b) { b.pop_back(); });
+    hashes.push_back(hash_bindings(base, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT));
+
+    //immutable samplers are part of the layout, the handle values are all that is read
+    std::vector<VkSampler> samplers(4);
+    for (size_t i = 0; i < samplers.size(); i++) {
+        samplers[i] = (VkSampler) (uintptr_t) (0x1000 + i);
+    }
+    changed([&](auto &b) { b[1].pImmutableSamplers = samplers.data(); });
+
+    std::unordered_set<uint64_t> unique(hashes.begin(), hashes.end());
+    SLIME_CHECK(t, unique.size() == hashes.size());
+});
@@ -0,0 +1,45 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "TestHarness.h"
+
+#include <cstdio>
+
+void TestContext::fail(const std::string &message, const char *file, int line) {
+    std::printf("    %s:%d: %s\n", file, line, message.c_str());
+    failures++;
+}
+
+TestRegistry &TestRegistry::get() {
+    static TestRegistry registry;
+    return registry;
+}
+
+void TestRegistry::add(const std::string &name, TestFunction function) {
+    mTests.emplace_back(name, std::move(function));
+}
+
+uint32_t TestRegistry::run(const std::string &filter) const {
+    uint32_t ran = 0;
+    uint32_t failed = 0;
+
+    for (const auto &[name, function]: mTests) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        std::printf("%s\n", name.c_str());
+        TestContext context;
+        function(context);
+        ran++;
+
+        if (context.failures != 0) {
+            std::printf("  FAILED, %u checks\n", context.failures);
+            failed++;
+        }
+    }
+
+    std::printf("%u of %u tests passed\n", ran - failed, ran);
+    return failed;
+}
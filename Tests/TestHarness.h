@@ -0,0 +1,64 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+//handed to every test, checks report through it and the test keeps going so one run shows every broken check
+struct TestContext {
+    uint32_t failures{0};
+
+    void fail(const std::string &message, const char *file, int line);
+};
+
+using TestFunction = std::function<void(TestContext &)>;
+
+class TestRegistry {
+public:
+    static TestRegistry &get();
+
+    void add(const std::string &name, TestFunction function);
+
+    //runs every test whose name contains filter, returns how many failed
+    uint32_t run(const std::string &filter) const;
+
+private:
+    std::vector<std::pair<std::string, TestFunction>> mTests;
+};
+
+struct TestRegistration {
+    TestRegistration(const std::string &name, TestFunction function) {
+        TestRegistry::get().add(name, std::move(function));
+    }
+};
+
+#define SLIME_TEST_CONCAT_INNER(a, b) a##b
+#define SLIME_TEST_CONCAT(a, b) SLIME_TEST_CONCAT_INNER(a, b)
+
+//registers a test at static init time: SLIME_TEST("group/name", [](TestContext &t) { ... });
+#define SLIME_TEST(name, ...) \
+    static TestRegistration SLIME_TEST_CONCAT(testRegistration, __LINE__){name, __VA_ARGS__}
+
+#define SLIME_CHECK(t, expression)                           \
+    do {                                                     \
+        if (!(expression)) {                                 \
+            (t).fail(#expression, __FILE__, __LINE__);       \
+        }                                                    \
+    } while (0)
+
+//for bounds, the failure shows both values
+#define SLIME_CHECK_LE(t, value, limit)                                                                   \
+    do {                                                                                                  \
+        auto slimeCheckValue = (value);                                                                   \
+        auto slimeCheckLimit = (limit);                                                                   \
+        if (!(slimeCheckValue <= slimeCheckLimit)) {                                                      \
+            (t).fail(std::string(#value " <= " #limit ", got ") + std::to_string(slimeCheckValue) + " > " + \
+                     std::to_string(slimeCheckLimit), __FILE__, __LINE__);                                \
+        }                                                                                                 \
+    } while (0)
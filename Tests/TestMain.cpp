@@ -0,0 +1,19 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "TestHarness.h"
+
+#include <cstring>
+
+int main(int argc, char *args[]) {
+    std::string filter;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(args[i], "--filter") == 0 && i + 1 < argc) {
+            filter = args[++i];
+        }
+    }
+
+    return TestRegistry::get().run(filter) == 0 ? 0 : 1;
+}
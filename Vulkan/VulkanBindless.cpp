@@ -0,0 +1,126 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "VulkanBindless.h"
+#include "VulkanInitializers.h"
+#include "VulkanTools.h"
+#include "Log.h"
+
+#include <algorithm>
+
+void BindlessTextureTable::init(VkDevice device, VkPhysicalDevice gpu, uint32_t capacity) {
+    mDevice = device;
+
+    VkPhysicalDeviceVulkan12Properties properties12{};
+    properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &properties12;
+    vkGetPhysicalDeviceProperties2(gpu, &properties);
+
+    mCapacity = std::min({capacity, properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+                          properties12.maxDescriptorSetUpdateAfterBindSamplers,
+                          properties12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                          properties12.maxPerStageDescriptorUpdateAfterBindSamplers});
+    if (mCapacity < capacity) {
+        Log::warn("Bindless texture table limited to " + std::to_string(mCapacity) + " textures by the device");
+    }
+
+    VkDescriptorSetLayoutBinding binding = vkslime::descriptorset_layout_binding(
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 0);
+    binding.descriptorCount = mCapacity;
+
+    //slots are written while the set is bound, and most of them are empty at any time
+    VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = 1;
+    bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+
+    VK_CHECK_RESULT(vkCreateDescriptorSetLayout(mDevice, &layoutInfo, nullptr, &mLayout));
+
+    VkDescriptorPoolSize poolSize = {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, mCapacity};
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    VK_CHECK_RESULT(vkCreateDescriptorPool(mDevice, &poolInfo, nullptr, &mPool));
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = mPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &mLayout;
+
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(mDevice, &allocInfo, &mSet));
+}
+
+void BindlessTextureTable::cleanup() {
+    //destroying the pool frees the set with it
+    vkDestroyDescriptorPool(mDevice, mPool, nullptr);
+    vkDestroyDescriptorSetLayout(mDevice, mLayout, nullptr);
+    mPool = VK_NULL_HANDLE;
+    mLayout = VK_NULL_HANDLE;
+    mSet = VK_NULL_HANDLE;
+
+    mNextSlot = 0;
+    mFreeSlots.clear();
+    mReleasedSlots.clear();
+}
+
+BindlessTextureIndex BindlessTextureTable::add(VkImageView view, VkSampler sampler) {
+    BindlessTextureIndex index;
+    if (!mFreeSlots.empty()) {
+        index = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    } else if (mNextSlot < mCapacity) {
+        index = mNextSlot++;
+    } else {
+        Log::error("Bindless texture table is full (" + std::to_string(mCapacity) + " textures)");
+        return INVALID_BINDLESS_TEXTURE;
+    }
+
+    VkDescriptorImageInfo imageInfo;
+    imageInfo.sampler = sampler;
+    imageInfo.imageView = view;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write = vkslime::write_descriptor_image(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, mSet,
+                                                                 &imageInfo, 0);
+    write.dstArrayElement = index;
+
+    vkUpdateDescriptorSets(mDevice, 1, &write, 0, nullptr);
+    return index;
+}
+
+void BindlessTextureTable::release(BindlessTextureIndex index, uint64_t timelineValue) {
+    if (index != INVALID_BINDLESS_TEXTURE) {
+        mReleasedSlots.push_back({index, timelineValue});
+    }
+}
+
+void BindlessTextureTable::collect(uint64_t completedTimelineValue) {
+    auto retired = std::stable_partition(mReleasedSlots.begin(), mReleasedSlots.end(),
+                                         [&](const ReleasedSlot &slot) {
+                                             return slot.timelineValue > completedTimelineValue;
+                                         });
+    for (auto it = retired; it != mReleasedSlots.end(); ++it) {
+        mFreeSlots.push_back(it->index);
+    }
+    mReleasedSlots.erase(retired, mReleasedSlots.end());
+}
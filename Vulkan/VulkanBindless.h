@@ -0,0 +1,60 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include "VulkanTypes.h"
+
+#include <vector>
+
+using BindlessTextureIndex = uint32_t;
+constexpr BindlessTextureIndex INVALID_BINDLESS_TEXTURE = UINT32_MAX;
+
+//one descriptor set holding every texture the engine samples, shaders index it with an index from the object data.
+//the set is bound once per frame and written with update-after-bind, so adding a texture never needs a new set.
+//a slot a frame in flight may read is never rewritten: replacing a texture takes a new slot and the old one is
+//only reused once the timeline has passed the last frame that could use it
+class BindlessTextureTable {
+public:
+    //capacity is clamped to what the device allows for update-after-bind samplers
+    void init(VkDevice device, VkPhysicalDevice gpu, uint32_t capacity);
+
+    void cleanup();
+
+    //writes the texture into a free slot. Returns INVALID_BINDLESS_TEXTURE when the table is full
+    BindlessTextureIndex add(VkImageView view, VkSampler sampler);
+
+    //the slot is free for reuse once the engine timeline reaches timelineValue
+    void release(BindlessTextureIndex index, uint64_t timelineValue);
+
+    //moves released slots the GPU is done with back to the free list
+    void collect(uint64_t completedTimelineValue);
+
+    VkDescriptorSetLayout get_layout() const { return mLayout; }
+
+    VkDescriptorSet get_set() const { return mSet; }
+
+    uint32_t get_capacity() const { return mCapacity; }
+
+    //slots currently holding a texture, released ones included until they are collected
+    uint32_t get_used() const { return mNextSlot - (uint32_t) mFreeSlots.size(); }
+
+private:
+    struct ReleasedSlot {
+        BindlessTextureIndex index;
+        uint64_t timelineValue;
+    };
+
+    VkDevice mDevice{VK_NULL_HANDLE};
+
+    VkDescriptorSetLayout mLayout{VK_NULL_HANDLE};
+    VkDescriptorPool mPool{VK_NULL_HANDLE};
+    VkDescriptorSet mSet{VK_NULL_HANDLE};
+    uint32_t mCapacity{0};
+
+    //slots below mNextSlot have been handed out at least once
+    uint32_t mNextSlot{0};
+    std::vector<BindlessTextureIndex> mFreeSlots;
+    std::vector<ReleasedSlot> mReleasedSlots;
+};
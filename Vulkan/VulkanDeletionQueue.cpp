@@ -0,0 +1,70 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "VulkanDeletionQueue.h"
+
+void DeletionQueue::append(DeletionQueue &other) {
+    entries.insert(entries.end(), other.entries.begin(), other.entries.end());
+    other.entries.clear();
+}
+
+void DeletionQueue::flush(VkDevice device, VmaAllocator allocator) {
+    // reverse iterate the deletion queue so resources go away before the things they were built from
+    for (auto it = entries.rbegin(); it != entries.rend(); it++) {
+        const DeletionEntry &entry = *it;
+
+        switch (entry.type) {
+            case DeletionType::Buffer:
+                vmaDestroyBuffer(allocator, from_handle_bits<VkBuffer>(entry.handle), entry.allocation);
+                break;
+            case DeletionType::Image:
+                vmaDestroyImage(allocator, from_handle_bits<VkImage>(entry.handle), entry.allocation);
+                break;
+            case DeletionType::ImageView:
+                vkDestroyImageView(device, from_handle_bits<VkImageView>(entry.handle), nullptr);
+                break;
+            case DeletionType::Sampler:
+                vkDestroySampler(device, from_handle_bits<VkSampler>(entry.handle), nullptr);
+                break;
+            case DeletionType::Pipeline:
+                vkDestroyPipeline(device, from_handle_bits<VkPipeline>(entry.handle), nullptr);
+                break;
+            case DeletionType::PipelineLayout:
+                vkDestroyPipelineLayout(device, from_handle_bits<VkPipelineLayout>(entry.handle), nullptr);
+                break;
+            case DeletionType::DescriptorSetLayout:
+                vkDestroyDescriptorSetLayout(device, from_handle_bits<VkDescriptorSetLayout>(entry.handle), nullptr);
+                break;
+            case DeletionType::DescriptorPool:
+                vkDestroyDescriptorPool(device, from_handle_bits<VkDescriptorPool>(entry.handle), nullptr);
+                break;
+            case DeletionType::RenderPass:
+                vkDestroyRenderPass(device, from_handle_bits<VkRenderPass>(entry.handle), nullptr);
+                break;
+            case DeletionType::Framebuffer:
+                vkDestroyFramebuffer(device, from_handle_bits<VkFramebuffer>(entry.handle), nullptr);
+                break;
+            case DeletionType::CommandPool:
+                vkDestroyCommandPool(device, from_handle_bits<VkCommandPool>(entry.handle), nullptr);
+                break;
+            case DeletionType::Semaphore:
+                vkDestroySemaphore(device, from_handle_bits<VkSemaphore>(entry.handle), nullptr);
+                break;
+            case DeletionType::Fence:
+                vkDestroyFence(device, from_handle_bits<VkFence>(entry.handle), nullptr);
+                break;
+            case DeletionType::ShaderModule:
+                vkDestroyShaderModule(device, from_handle_bits<VkShaderModule>(entry.handle), nullptr);
+                break;
+            case DeletionType::Swapchain:
+                vkDestroySwapchainKHR(device, from_handle_bits<VkSwapchainKHR>(entry.handle), nullptr);
+                break;
+            case DeletionType::QueryPool:
+                vkDestroyQueryPool(device, from_handle_bits<VkQueryPool>(entry.handle), nullptr);
+                break;
+        }
+    }
+
+    entries.clear();
+}
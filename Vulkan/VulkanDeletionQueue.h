@@ -0,0 +1,84 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include "VulkanTypes.h"
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+//every kind of handle the deletion queue knows how to destroy
+enum class DeletionType : uint8_t {
+    Buffer,
+    Image,
+    ImageView,
+    Sampler,
+    Pipeline,
+    PipelineLayout,
+    DescriptorSetLayout,
+    DescriptorPool,
+    RenderPass,
+    Framebuffer,
+    CommandPool,
+    Semaphore,
+    Fence,
+    ShaderModule,
+    Swapchain,
+    QueryPool
+};
+
+//a single queued destruction. Non-dispatchable handles are 64 bits wide on every platform, so they all fit in handle
+struct DeletionEntry {
+    DeletionType type;
+    uint64_t handle;
+    VmaAllocation allocation; //only set for buffers and images
+};
+
+//records handles in one contiguous array and destroys them in a single pass.
+//flushing keeps the array capacity, so once the queue has grown queueing a deletion no longer allocates
+struct DeletionQueue {
+    std::vector<DeletionEntry> entries;
+
+    template<typename T>
+    void push(DeletionType type, T handle, VmaAllocation allocation = VK_NULL_HANDLE) {
+        entries.push_back({type, to_handle_bits(handle), allocation});
+    }
+
+    void push_buffer(const AllocatedBufferUntyped &buffer) {
+        push(DeletionType::Buffer, buffer.mBuffer, buffer.mAllocation);
+    }
+
+    //destroys the default view as well if the image has one
+    void push_image(const AllocatedImage &image) {
+        push(DeletionType::Image, image.mImage, image.mAllocation);
+        if (image.mDefaultView != VK_NULL_HANDLE) {
+            push(DeletionType::ImageView, image.mDefaultView);
+        }
+    }
+
+    //moves every entry of other to the back of this queue, leaving other empty
+    void append(DeletionQueue &other);
+
+    //destroys everything in reverse order of insertion
+    void flush(VkDevice device, VmaAllocator allocator);
+
+    template<typename T>
+    static uint64_t to_handle_bits(T handle) {
+        if constexpr (std::is_pointer_v<T>) {
+            return reinterpret_cast<uint64_t>(handle);
+        } else {
+            return static_cast<uint64_t>(handle);
+        }
+    }
+
+    template<typename T>
+    static T from_handle_bits(uint64_t bits) {
+        if constexpr (std::is_pointer_v<T>) {
+            return reinterpret_cast<T>(static_cast<uintptr_t>(bits));
+        } else {
+            return static_cast<T>(bits);
+        }
+    }
+};
@@ -3,6 +3,7 @@
 //
 
 #include "VulkanDescriptors.h"
+#include "VulkanHash.h"
 
 #include <algorithm>
 
@@ -33,12 +34,13 @@ namespace vkutil {
             vkResetDescriptorPool(device, p, 0);
         }
 
-        freePools = usedPools;
+        //pools nobody grabbed since the last reset are still free, keep them
+        freePools.insert(freePools.end(), usedPools.begin(), usedPools.end());
         usedPools.clear();
         currentPool = VK_NULL_HANDLE;
     }
 
-    bool DescriptorAllocator::allocate(VkDescriptorSet *set, VkDescriptorSetLayout layout) {
+    bool DescriptorAllocator::allocate(VkDescriptorSet *set, VkDescriptorSetLayout layout, VkDescriptorPool *outPool) {
         if (currentPool == VK_NULL_HANDLE) {
             currentPool = grab_pool();
             usedPools.push_back(currentPool);
@@ -58,6 +60,9 @@ namespace vkutil {
         switch (allocResult) {
             case VK_SUCCESS:
                 //all good, return
+                if (outPool != nullptr) {
+                    *outPool = currentPool;
+                }
                 return true;
             case VK_ERROR_FRAGMENTED_POOL:
             case VK_ERROR_OUT_OF_POOL_MEMORY:
@@ -67,24 +72,27 @@ namespace vkutil {
                 return false;
         }
 
-        if (allocResult == VK_ERROR_OUT_OF_POOL_MEMORY) {
-            //allocate a new pool and retry
-            currentPool = grab_pool();
-            usedPools.push_back(currentPool);
+        //allocate a new pool and retry, pools that free sets can fragment as well as fill up
+        currentPool = grab_pool();
+        usedPools.push_back(currentPool);
+        allocInfo.descriptorPool = currentPool;
 
-            allocResult = vkAllocateDescriptorSets(device, &allocInfo, set);
+        allocResult = vkAllocateDescriptorSets(device, &allocInfo, set);
 
-            //if it still fails then we have big issues
-            if (allocResult == VK_SUCCESS) {
-                return true;
+        //if it still fails then we have big issues
+        if (allocResult == VK_SUCCESS) {
+            if (outPool != nullptr) {
+                *outPool = currentPool;
             }
+            return true;
         }
 
         return false;
     }
 
-    void DescriptorAllocator::init(VkDevice newDevice) {
+    void DescriptorAllocator::init(VkDevice newDevice, VkDescriptorPoolCreateFlags newPoolFlags) {
         device = newDevice;
+        poolFlags = newPoolFlags;
     }
 
     void DescriptorAllocator::cleanup() {
@@ -95,6 +103,9 @@ namespace vkutil {
         for (auto p: usedPools) {
             vkDestroyDescriptorPool(device, p, nullptr);
         }
+        freePools.clear();
+        usedPools.clear();
+        currentPool = VK_NULL_HANDLE;
     }
 
     VkDescriptorPool DescriptorAllocator::grab_pool() {
@@ -103,7 +114,7 @@ namespace vkutil {
             freePools.pop_back();
             return pool;
         } else {
-            return createPool(device, descriptorSizes, 1000, 0);
+            return createPool(device, descriptorSizes, 1000, poolFlags);
         }
     }
 
@@ -114,25 +125,7 @@ namespace vkutil {
 
     VkDescriptorSetLayout DescriptorLayoutCache::create_descriptor_layout(VkDescriptorSetLayoutCreateInfo *info) {
         DescriptorLayoutInfo layoutinfo;
-        layoutinfo.bindings.reserve(info->bindingCount);
-        bool isSorted = true;
-        uint32_t lastBinding = -1;
-        for (uint32_t i = 0; i < info->bindingCount; i++) {
-            layoutinfo.bindings.push_back(info->pBindings[i]);
-
-            //check that the bindings are in strict increasing order
-            if (static_cast<uint32_t>(info->pBindings[i].binding) > lastBinding) {
-                lastBinding = info->pBindings[i].binding;
-            } else {
-                isSorted = false;
-            }
-        }
-        if (!isSorted) {
-            std::sort(layoutinfo.bindings.begin(), layoutinfo.bindings.end(),
-                      [](VkDescriptorSetLayoutBinding &a, VkDescriptorSetLayoutBinding &b) {
-                          return a.binding < b.binding;
-                      });
-        }
+        layoutinfo.set(*info);
 
         auto it = layoutCache.find(layoutinfo);
         if (it != layoutCache.end()) {
@@ -141,9 +134,8 @@ namespace vkutil {
             VkDescriptorSetLayout layout;
             vkCreateDescriptorSetLayout(device, info, nullptr, &layout);
 
-            //layoutCache.emplace()
             //add to cache
-            layoutCache[layoutinfo] = layout;
+            layoutCache.emplace(std::move(layoutinfo), layout);
             return layout;
         }
     }
@@ -154,6 +146,126 @@ namespace vkutil {
         for (const auto& pair: layoutCache) {
             vkDestroyDescriptorSetLayout(device, pair.second, nullptr);
         }
+        layoutCache.clear();
+    }
+
+    void DescriptorSetCache::init(VkDevice newDevice, uint32_t newEvictAfterFrames) {
+        device = newDevice;
+        evictAfterFrames = newEvictAfterFrames;
+        allocator.init(newDevice, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+    }
+
+    void DescriptorSetCache::cleanup() {
+        //the pools take their sets with them
+        allocator.cleanup();
+        entries.clear();
+        freeEntries.clear();
+        lookup.clear();
+    }
+
+    void DescriptorSetCache::begin_frame(uint64_t frameNumber) {
+        currentFrame = frameNumber;
+        hits = 0;
+        misses = 0;
+
+        for (uint32_t i = 0; i < entries.size(); i++) {
+            Entry &entry = entries[i];
+            if (entry.set == VK_NULL_HANDLE || frameNumber - entry.lastUsedFrame < evictAfterFrames) {
+                continue;
+            }
+
+            vkFreeDescriptorSets(device, entry.pool, 1, &entry.set);
+            lookup.erase(entry.hash);
+
+            entry.set = VK_NULL_HANDLE;
+            entry.key.clear();
+            freeEntries.push_back(i);
+        }
+    }
+
+    void DescriptorSetCache::pack_key(VkDescriptorSetLayout layout, const VkWriteDescriptorSet *writes,
+                                      uint32_t writeCount) {
+        scratchKey.clear();
+        scratchKey.push_back((uint64_t) layout);
+
+        for (uint32_t i = 0; i < writeCount; i++) {
+            const VkWriteDescriptorSet &write = writes[i];
+            scratchKey.push_back((uint64_t) write.descriptorType << 32 | write.dstBinding);
+            scratchKey.push_back((uint64_t) write.descriptorCount << 32 | write.dstArrayElement);
+
+            for (uint32_t d = 0; d < write.descriptorCount; d++) {
+                if (write.pBufferInfo != nullptr) {
+                    scratchKey.push_back((uint64_t) write.pBufferInfo[d].buffer);
+                    scratchKey.push_back(write.pBufferInfo[d].offset);
+                    scratchKey.push_back(write.pBufferInfo[d].range);
+                } else if (write.pImageInfo != nullptr) {
+                    scratchKey.push_back((uint64_t) write.pImageInfo[d].sampler);
+                    scratchKey.push_back((uint64_t) write.pImageInfo[d].imageView);
+                    scratchKey.push_back(write.pImageInfo[d].imageLayout);
+                } else if (write.pTexelBufferView != nullptr) {
+                    scratchKey.push_back((uint64_t) write.pTexelBufferView[d]);
+                }
+            }
+        }
+    }
+
+    bool DescriptorSetCache::get(VkDescriptorSetLayout layout, VkWriteDescriptorSet *writes, uint32_t writeCount,
+                                 VkDescriptorSet &set) {
+        pack_key(layout, writes, writeCount);
+
+        Hasher64 hasher;
+        for (uint64_t word: scratchKey) {
+            hasher.add(word);
+        }
+        uint64_t hash = hasher.finish();
+
+        auto it = lookup.find(hash);
+        if (it != lookup.end()) {
+            Entry &entry = entries[it->second];
+            if (entry.layout == layout && entry.key == scratchKey) {
+                entry.lastUsedFrame = currentFrame;
+                set = entry.set;
+                hits++;
+                return true;
+            }
+        }
+        misses++;
+
+        VkDescriptorPool pool;
+        if (!allocator.allocate(&set, layout, &pool)) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < writeCount; i++) {
+            writes[i].dstSet = set;
+        }
+        vkUpdateDescriptorSets(device, writeCount, writes, 0, nullptr);
+
+        //different contents with the same 64 bit hash, not worth an entry of its own. The set is used uncached
+        //and lives until cleanup
+        if (it != lookup.end()) {
+            return true;
+        }
+
+        uint32_t index;
+        if (!freeEntries.empty()) {
+            index = freeEntries.back();
+            freeEntries.pop_back();
+        } else {
+            index = (uint32_t) entries.size();
+            entries.emplace_back();
+        }
+
+        Entry &entry = entries[index];
+        entry.layout = layout;
+        entry.key = scratchKey;
+        entry.hash = hash;
+        entry.set = set;
+        entry.pool = pool;
+        entry.lastUsedFrame = currentFrame;
+        lookup[hash] = index;
+
+        return true;
     }
 
     vkutil::DescriptorBuilder
@@ -253,44 +365,56 @@ namespace vkutil {
     }
 
 
-    bool DescriptorLayoutCache::DescriptorLayoutInfo::operator==(const DescriptorLayoutInfo &other) const {
-        if (other.bindings.size() != bindings.size()) {
-            return false;
-        } else {
-            //compare each of the bindings is the same. Bindings are sorted so they will match
-            for (int i = 0; i < bindings.size(); i++) {
-                if (other.bindings[i].binding != bindings[i].binding) {
-                    return false;
-                }
-                if (other.bindings[i].descriptorType != bindings[i].descriptorType) {
-                    return false;
-                }
-                if (other.bindings[i].descriptorCount != bindings[i].descriptorCount) {
-                    return false;
-                }
-                if (other.bindings[i].stageFlags != bindings[i].stageFlags) {
-                    return false;
-                }
+    void DescriptorLayoutCache::DescriptorLayoutInfo::set(const VkDescriptorSetLayoutCreateInfo &info) {
+        flags = info.flags;
+        bindingCount = info.bindingCount;
+
+        VkDescriptorSetLayoutBinding *sorted = inlineBindings.data();
+        if (bindingCount > INLINE_BINDINGS) {
+            overflowBindings.resize(bindingCount);
+            sorted = overflowBindings.data();
+        }
+
+        //insertion sort by binding number, bindings nearly always arrive sorted already
+        for (uint32_t i = 0; i < bindingCount; i++) {
+            VkDescriptorSetLayoutBinding binding = info.pBindings[i];
+            uint32_t j = i;
+            while (j > 0 && sorted[j - 1].binding > binding.binding) {
+                sorted[j] = sorted[j - 1];
+                j--;
             }
-            return true;
+            sorted[j] = binding;
         }
-    }
 
-    size_t DescriptorLayoutCache::DescriptorLayoutInfo::hash() const {
-        using std::size_t;
-        using std::hash;
+        hashValue = hash_descriptor_bindings(sorted, bindingCount, flags);
 
-        size_t result = hash<size_t>()(bindings.size());
+        //immutable samplers are only covered by the hash, the key must not point into the caller's memory
+        for (uint32_t i = 0; i < bindingCount; i++) {
+            sorted[i].pImmutableSamplers = nullptr;
+        }
+    }
 
-        for (const VkDescriptorSetLayoutBinding &b: bindings) {
-            //pack the binding data into a single int64. Not fully correct but its ok
-            size_t binding_hash = b.binding | b.descriptorType << 8 | b.descriptorCount << 16 | b.stageFlags << 24;
+    const VkDescriptorSetLayoutBinding *DescriptorLayoutCache::DescriptorLayoutInfo::bindings() const {
+        return bindingCount > INLINE_BINDINGS ? overflowBindings.data() : inlineBindings.data();
+    }
 
-            //shuffle the packed binding data and xor it with the main hash
-            result ^= hash<size_t>()(binding_hash);
+    bool DescriptorLayoutCache::DescriptorLayoutInfo::operator==(const DescriptorLayoutInfo &other) const {
+        if (other.hashValue != hashValue || other.bindingCount != bindingCount || other.flags != flags) {
+            return false;
         }
 
-        return result;
+        //compare each of the bindings is the same. Bindings are sorted so they will match
+        const VkDescriptorSetLayoutBinding *a = bindings();
+        const VkDescriptorSetLayoutBinding *b = other.bindings();
+        for (uint32_t i = 0; i < bindingCount; i++) {
+            if (a[i].binding != b[i].binding ||
+                a[i].descriptorType != b[i].descriptorType ||
+                a[i].descriptorCount != b[i].descriptorCount ||
+                a[i].stageFlags != b[i].stageFlags) {
+                return false;
+            }
+        }
+        return true;
     }
 
 }
\ No newline at end of file
@@ -34,9 +34,11 @@ namespace vkutil {
 
         void reset_pools();
 
-        bool allocate(VkDescriptorSet *set, VkDescriptorSetLayout layout);
+        //outPool receives the pool the set came from, needed to free it from pools created with
+        //VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT
+        bool allocate(VkDescriptorSet *set, VkDescriptorSetLayout layout, VkDescriptorPool *outPool = nullptr);
 
-        void init(VkDevice newDevice);
+        void init(VkDevice newDevice, VkDescriptorPoolCreateFlags newPoolFlags = 0);
 
         void cleanup();
 
@@ -45,6 +47,7 @@ namespace vkutil {
         VkDescriptorPool grab_pool();
 
         VkDescriptorPool currentPool{VK_NULL_HANDLE};
+        VkDescriptorPoolCreateFlags poolFlags{0};
         PoolSizes descriptorSizes;
         std::vector<VkDescriptorPool> usedPools;
         std::vector<VkDescriptorPool> freePools;
@@ -59,13 +62,25 @@ namespace vkutil {
 
         VkDescriptorSetLayout create_descriptor_layout(VkDescriptorSetLayoutCreateInfo *info);
 
+        //lookup key of a layout. Bindings are kept sorted by binding number, and up to INLINE_BINDINGS of them
+        //are stored inline so looking up a layout doesn't allocate
         struct DescriptorLayoutInfo {
-            //good idea to turn this into a inlined array
-            std::vector<VkDescriptorSetLayoutBinding> bindings;
+            static constexpr uint32_t INLINE_BINDINGS = 8;
+
+            void set(const VkDescriptorSetLayoutCreateInfo &info);
+
+            const VkDescriptorSetLayoutBinding *bindings() const;
 
             bool operator==(const DescriptorLayoutInfo &other) const;
 
-            size_t hash() const;
+            size_t hash() const { return (size_t) hashValue; }
+
+            VkDescriptorSetLayoutCreateFlags flags{0};
+            uint32_t bindingCount{0};
+            std::array<VkDescriptorSetLayoutBinding, INLINE_BINDINGS> inlineBindings{};
+            //only used by layouts with more than INLINE_BINDINGS bindings
+            std::vector<VkDescriptorSetLayoutBinding> overflowBindings;
+            uint64_t hashValue{0};
         };
 
 
@@ -83,6 +98,60 @@ namespace vkutil {
     };
 
 
+    //descriptor sets keyed by their layout and the resources written into them. A set written once is handed
+    //out again for as long as something asks for the same contents, and freed after evictAfterFrames frames
+    //without a request. evictAfterFrames has to cover the frames in flight, so an evicted set is never pending
+    class DescriptorSetCache {
+    public:
+        void init(VkDevice newDevice, uint32_t newEvictAfterFrames);
+
+        void cleanup();
+
+        //evicts sets not requested in the last evictAfterFrames frames, call once per frame after its fence wait
+        void begin_frame(uint64_t frameNumber);
+
+        //returns a set with the writes applied, only allocating and writing one when no cached set matches.
+        //dstSet of the writes is ignored
+        bool get(VkDescriptorSetLayout layout, VkWriteDescriptorSet *writes, uint32_t writeCount,
+                 VkDescriptorSet &set);
+
+        //cache hits and misses since the last begin_frame
+        uint32_t get_hits() const { return hits; }
+
+        uint32_t get_misses() const { return misses; }
+
+        size_t get_size() const { return lookup.size(); }
+
+    private:
+        struct Entry {
+            VkDescriptorSetLayout layout{VK_NULL_HANDLE};
+            //packed write contents, compared on a hash match so colliding keys never share a set
+            std::vector<uint64_t> key;
+            uint64_t hash{0};
+            VkDescriptorSet set{VK_NULL_HANDLE};
+            VkDescriptorPool pool{VK_NULL_HANDLE};
+            uint64_t lastUsedFrame{0};
+        };
+
+        //fills scratchKey with the layout and every field of the writes that ends up in the set
+        void pack_key(VkDescriptorSetLayout layout, const VkWriteDescriptorSet *writes, uint32_t writeCount);
+
+        VkDevice device{VK_NULL_HANDLE};
+        //pools are created with the free bit so evicted sets go back to them
+        DescriptorAllocator allocator;
+        uint32_t evictAfterFrames{0};
+        uint64_t currentFrame{0};
+
+        std::vector<Entry> entries;
+        std::vector<uint32_t> freeEntries;
+        std::unordered_map<uint64_t, uint32_t> lookup;
+        std::vector<uint64_t> scratchKey;
+
+        uint32_t hits{0};
+        uint32_t misses{0};
+    };
+
+
     class DescriptorBuilder {
     public:
 
@@ -28,36 +28,68 @@
 
 namespace fs = std::filesystem;
 
+#ifdef TRACY_ENABLE
+//every VkDeviceMemory block VMA allocates or frees shows up in Tracy's memory view
+static void VKAPI_PTR tracy_vma_allocate(VmaAllocator allocator, uint32_t memoryType, VkDeviceMemory memory,
+                                         VkDeviceSize size, void *pUserData) {
+    TracyAllocN((void *) memory, (size_t) size, "Vulkan Device Memory");
+}
+
+static void VKAPI_PTR tracy_vma_free(VmaAllocator allocator, uint32_t memoryType, VkDeviceMemory memory,
+                                     VkDeviceSize size, void *pUserData) {
+    TracyFreeN((void *) memory, "Vulkan Device Memory");
+}
+#endif
 
-void VulkanEngine::init() {
+
+bool VulkanEngine::init(const EngineConfig &config) {
     auto start = std::chrono::steady_clock::now();
     Log::init();
 
     ZoneScopedN("Engine Init")
 
-    // Get current project path for file reading
-    mCurrentProjectPath = std::filesystem::current_path().string();
+    mRequestedPresentMode = config.presentMode;
+    mHeadless = config.headless;
+    mHeadlessFrameCount = config.headlessFrames;
+    mHeadlessDumpPath = config.headlessDumpPath;
+    mWindowExtent = config.extent;
 
-    // We initialize SDL and create a window with it.
-    SDL_Init(SDL_INIT_VIDEO);
+    mFramesInFlight = std::clamp(config.framesInFlight, 1u, MAX_FRAMES_IN_FLIGHT);
+    if (mFramesInFlight != config.framesInFlight) {
+        Log::warn("Requested " + std::to_string(config.framesInFlight) + " frames in flight, using " +
+                  std::to_string(mFramesInFlight));
+    }
 
-    SDL_WindowFlags windowFlags = SDL_WINDOW_VULKAN;
+    // Get current project path for file reading
+    mCurrentProjectPath = std::filesystem::current_path().string();
 
-    //create blank SDL window for our application
-    mWindow = SDL_CreateWindow(
-            "Vulkan Slime", //window title
-            SDL_WINDOWPOS_UNDEFINED, //window position x
-            SDL_WINDOWPOS_UNDEFINED, //window position y
-            (int) mWindowExtent.width,  //window width in pixels
-            (int) mWindowExtent.height, //window height in pixels
-            windowFlags
-    );
+    //headless runs never touch SDL, so they work on machines without a display
+    if (!mHeadless) {
+        // We initialize SDL and create a window with it.
+        SDL_Init(SDL_INIT_VIDEO);
+
+        auto windowFlags = (SDL_WindowFlags) (SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
+
+        //create blank SDL window for our application
+        mWindow = SDL_CreateWindow(
+                "Vulkan Slime", //window title
+                SDL_WINDOWPOS_UNDEFINED, //window position x
+                SDL_WINDOWPOS_UNDEFINED, //window position y
+                (int) mWindowExtent.width,  //window width in pixels
+                (int) mWindowExtent.height, //window height in pixels
+                windowFlags
+        );
+    }
 
     //load the core Vulkan structures
     init_vulkan();
 
-    //create the swapchain
-    init_swapchain();
+    //create the swapchain, or the offscreen images that stand in for it
+    if (mHeadless) {
+        init_offscreen_targets();
+    } else {
+        init_swapchain();
+    }
 
     //Create Command Pools and command buffers
     init_commands();
@@ -73,7 +105,18 @@ void VulkanEngine::init() {
 
     init_descriptors();
 
-    init_pipeline();
+    //nothing can be drawn without the lit pipeline, so there is no point going on
+    if (!init_pipeline()) {
+        Log::error("Failed to create the lit pipeline, shutting down");
+        return false;
+    }
+
+    if (!mHeadless && config.shaderHotReload) {
+        mShaderReloader.init(SHADER_SOURCE_DIRECTORY, SHADER_DIRECTORY, VKSLIME_GLSLANG_VALIDATOR);
+    }
+
+    //needs the allocator for its budget, and has to be up before textures are loaded into it
+    mTextureStreamer.init(this, config.textureStreaming);
 
     load_images();
 
@@ -81,9 +124,11 @@ void VulkanEngine::init() {
 
     init_scene();
 
-    init_imgui();
+    if (!mHeadless) {
+        init_imgui();
 
-    layer.init();
+        layer.init();
+    }
 
     //everything went fine
     mIsInitialized = true;
@@ -91,6 +136,7 @@ void VulkanEngine::init() {
     auto end = std::chrono::steady_clock::now();
     auto time = std::chrono::duration<double>(end - start).count();
     Log::warn("StartUp Time: " + std::to_string(time) + " Seconds.");
+    return true;
 }
 
 void VulkanEngine::init_vulkan() {
@@ -102,6 +148,7 @@ void VulkanEngine::init_vulkan() {
                     .request_validation_layers(true)
                     .require_api_version(1, 2, 0)
                     .use_default_debug_messenger()
+                    .set_headless(mHeadless)
                     .build();
 
     vkb::Instance vkb_inst = inst_ret.value();
@@ -112,18 +159,43 @@ void VulkanEngine::init_vulkan() {
     mDebugMessenger = vkb_inst.debug_messenger;
 
     // get the surface of the window we opened with SDL
-    SDL_Vulkan_CreateSurface(mWindow, mInstance, &mSurface);
+    if (!mHeadless) {
+        SDL_Vulkan_CreateSurface(mWindow, mInstance, &mSurface);
+    }
+
+    //frame pacing and uploads are synchronised with a timeline semaphore, core in Vulkan 1.2 but still opt-in
+    VkPhysicalDeviceVulkan12Features features12{};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features12.timelineSemaphore = VK_TRUE;
+    //materials index one bindless texture array, written while it is bound
+    features12.descriptorIndexing = VK_TRUE;
+    features12.runtimeDescriptorArray = VK_TRUE;
+    features12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    features12.descriptorBindingPartiallyBound = VK_TRUE;
+    features12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    features12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+
+    //baked textures are stored in BC formats, supported by every desktop GPU
+    VkPhysicalDeviceFeatures features{};
+    features.textureCompressionBC = VK_TRUE;
 
     //use vkbootstrap to select a GPU.
-    //We want a GPU that can write to the SDL surface and supports Vulkan 1.2
+    //We want a GPU that can write to the SDL surface and supports Vulkan 1.2, headless runs skip the present check
     vkb::PhysicalDeviceSelector selector{vkb_inst};
+    if (!mHeadless) {
+        selector.set_surface(mSurface);
+    }
     vkb::PhysicalDevice physicalDevice = selector
             .set_minimum_version(1, 2)
-            .set_surface(mSurface)
+            .set_required_features(features)
+            .set_required_features_12(features12)
             .add_required_extension("VK_KHR_shader_draw_parameters")
             .select()
             .value();
 
+    //lets VMA report real per-heap budgets instead of estimates, the texture streamer sizes itself from them
+    bool memoryBudget = physicalDevice.enable_extension_if_present(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
     //create the final Vulkan device
     vkb::DeviceBuilder deviceBuilder{physicalDevice};
 
@@ -142,11 +214,19 @@ void VulkanEngine::init_vulkan() {
     allocatorInfo.physicalDevice = mChosenGPU;
     allocatorInfo.device = mDevice;
     allocatorInfo.instance = mInstance;
-    vmaCreateAllocator(&allocatorInfo, &mAllocator);
+    allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_2;
+    if (memoryBudget) {
+        allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
 
-    mMainDeletionQueue.push_function([this]() {
-        vmaDestroyAllocator(mAllocator);
-    });
+#ifdef TRACY_ENABLE
+    VmaDeviceMemoryCallbacks memoryCallbacks = {};
+    memoryCallbacks.pfnAllocate = tracy_vma_allocate;
+    memoryCallbacks.pfnFree = tracy_vma_free;
+    allocatorInfo.pDeviceMemoryCallbacks = &memoryCallbacks;
+#endif
+
+    vmaCreateAllocator(&allocatorInfo, &mAllocator);
 
     mGpuProperties = vkbDevice.physical_device.properties;
 }
@@ -166,6 +246,23 @@ void VulkanEngine::init_swapchain() {
             mChosenGPU, mSurface, &formatCount, surfaceFormats.data());
     assert(result == VK_SUCCESS);
 
+    //FIFO is the only present mode every device has to support, anything else is used only if available
+    uint32_t presentModeCount = 0;
+    result = vkGetPhysicalDeviceSurfacePresentModesKHR(mChosenGPU, mSurface, &presentModeCount, nullptr);
+    assert(result == VK_SUCCESS);
+
+    std::vector<VkPresentModeKHR> presentModes(presentModeCount);
+    result = vkGetPhysicalDeviceSurfacePresentModesKHR(mChosenGPU, mSurface, &presentModeCount, presentModes.data());
+    assert(result == VK_SUCCESS);
+
+    mPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+    if (std::find(presentModes.begin(), presentModes.end(), mRequestedPresentMode) != presentModes.end()) {
+        mPresentMode = mRequestedPresentMode;
+    } else {
+        Log::warn("Present mode " + vkslime::tools::presentModeString(mRequestedPresentMode) +
+                  " is not supported, falling back to FIFO");
+    }
+
     auto sRGBFormat = VkSurfaceFormatKHR{VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
     auto adobeRGBFormat = VkSurfaceFormatKHR{VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_ADOBERGB_NONLINEAR_EXT};
     bool adobeRGBfound = false;
@@ -175,15 +272,22 @@ void VulkanEngine::init_swapchain() {
     }
 
 
+    //when recreating, the old swapchain is handed over so the driver can reuse its resources
+    VkSwapchainKHR oldSwapchain = mSwapchain;
+
     vkb::Swapchain vkbSwapchain = swapchainBuilder
             .use_default_format_selection()
-                    //use vsync present mode
-            .set_desired_present_mode(VK_PRESENT_MODE_FIFO_KHR)
+            .set_desired_present_mode(mPresentMode)
             .set_desired_extent(mWindowExtent.width, mWindowExtent.height)
             .set_desired_format((adobeRGBfound) ? adobeRGBFormat : sRGBFormat)
+            .set_old_swapchain(oldSwapchain)
             .build()
             .value();
 
+    if (oldSwapchain != VK_NULL_HANDLE) {
+        vkDestroySwapchainKHR(mDevice, oldSwapchain, nullptr);
+    }
+
     //store swapchain and its related images
     mSwapchain = vkbSwapchain.swapchain;
     mSwapchainImages = vkbSwapchain.get_images().value();
@@ -191,9 +295,18 @@ void VulkanEngine::init_swapchain() {
 
     mSwapchainImageFormat = vkbSwapchain.image_format;
 
+    //the surface decides the final size, which may differ from the one we asked for
+    mWindowExtent = vkbSwapchain.extent;
+
     Log::info("Current swapchain framebuffer colour format: " + std::to_string(mSwapchainImageFormat) +
               ", Lookup table: https://tinyurl.com/bdfz9u6v");
+    Log::info("Swapchain " + std::to_string(mWindowExtent.width) + "x" + std::to_string(mWindowExtent.height) +
+              ", present mode " + vkslime::tools::presentModeString(mPresentMode));
+
+    init_depth_image();
+}
 
+void VulkanEngine::init_depth_image() {
     //depth image size will match the window
     VkExtent3D depthImageExtent = {
             mWindowExtent.width,
@@ -221,12 +334,97 @@ void VulkanEngine::init_swapchain() {
                                                                       VK_IMAGE_ASPECT_DEPTH_BIT);
 
     VK_CHECK_RESULT(vkCreateImageView(mDevice, &dview_info, nullptr, &mDepthImageView));
+}
 
-    mMainDeletionQueue.push_function([this]() {
-        vkDestroyImageView(mDevice, mDepthImageView, nullptr);
-        vmaDestroyImage(mAllocator, mDepthImage.mImage, mDepthImage.mAllocation);
-        vkDestroySwapchainKHR(mDevice, mSwapchain, nullptr);
-    });
+void VulkanEngine::init_offscreen_targets() {
+    //same format the window path prefers, so pipelines and the render pass do not care which one is used
+    mSwapchainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+
+    VkExtent3D imageExtent = {
+            mWindowExtent.width,
+            mWindowExtent.height,
+            1
+    };
+
+    //one target per frame in flight, the frame's timeline wait is all that is needed before reusing it
+    VkImageCreateInfo img_info = vkslime::image_create_info(mSwapchainImageFormat,
+                                                            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                                                            VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                                                            imageExtent);
+
+    VmaAllocationCreateInfo img_allocinfo = {};
+    img_allocinfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    img_allocinfo.requiredFlags = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    mOffscreenImages.resize(mFramesInFlight);
+    for (AllocatedImage &image: mOffscreenImages) {
+        VK_CHECK_RESULT(vmaCreateImage(mAllocator, &img_info, &img_allocinfo, &image.mImage, &image.mAllocation,
+                                       nullptr));
+
+        VkImageViewCreateInfo view_info = vkslime::imageview_create_info(mSwapchainImageFormat, image.mImage,
+                                                                         VK_IMAGE_ASPECT_COLOR_BIT);
+        VK_CHECK_RESULT(vkCreateImageView(mDevice, &view_info, nullptr, &image.mDefaultView));
+
+        //the rest of the renderer only sees these as swapchain images
+        mSwapchainImages.push_back(image.mImage);
+        mSwapchainImageViews.push_back(image.mDefaultView);
+    }
+
+    Log::info("Headless offscreen targets " + std::to_string(mWindowExtent.width) + "x" +
+              std::to_string(mWindowExtent.height));
+
+    //same depth buffer as the windowed path
+    init_depth_image();
+}
+
+void VulkanEngine::destroy_swapchain_resources() {
+    //the swapchain handle itself stays alive so it can be passed as the old swapchain when recreating
+    for (size_t i = 0; i < mFramebuffers.size(); i++) {
+        vkDestroyFramebuffer(mDevice, mFramebuffers[i], nullptr);
+        vkDestroyImageView(mDevice, mSwapchainImageViews[i], nullptr);
+    }
+    mFramebuffers.clear();
+    mSwapchainImageViews.clear();
+    mSwapchainImages.clear();
+
+    //offscreen views were destroyed with the swapchain views above
+    for (AllocatedImage &image: mOffscreenImages) {
+        vmaDestroyImage(mAllocator, image.mImage, image.mAllocation);
+    }
+    mOffscreenImages.clear();
+
+    vkDestroyImageView(mDevice, mDepthImageView, nullptr);
+    vmaDestroyImage(mAllocator, mDepthImage.mImage, mDepthImage.mAllocation);
+}
+
+bool VulkanEngine::recreate_swapchain() {
+    int width = 0;
+    int height = 0;
+    SDL_Vulkan_GetDrawableSize(mWindow, &width, &height);
+
+    //a minimized window has nothing to render to, try again once it is restored
+    if (width == 0 || height == 0) {
+        return false;
+    }
+
+    //the old framebuffers and depth image may still be used by frames in flight
+    vkDeviceWaitIdle(mDevice);
+
+    destroy_swapchain_resources();
+
+    mWindowExtent.width = (uint32_t) width;
+    mWindowExtent.height = (uint32_t) height;
+
+    init_swapchain();
+    init_framebuffers();
+
+    mSwapchainDirty = false;
+    return true;
+}
+
+void VulkanEngine::set_present_mode(VkPresentModeKHR presentMode) {
+    mRequestedPresentMode = presentMode;
+    mSwapchainDirty = true;
 }
 
 void VulkanEngine::init_commands() {
@@ -235,7 +433,8 @@ void VulkanEngine::init_commands() {
     VkCommandPoolCreateInfo commandPoolInfo = vkslime::command_pool_create_info(mGraphicsQueueFamily,
                                                                                 VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 
-    for (auto &frame: mFrames) {
+    for (uint32_t i = 0; i < mFramesInFlight; i++) {
+        FrameData &frame = mFrames[i];
         VK_CHECK_RESULT(vkCreateCommandPool(mDevice, &commandPoolInfo, nullptr, &frame.mCommandPool));
 
         //allocate the default command buffer that we will use for rendering
@@ -243,18 +442,14 @@ void VulkanEngine::init_commands() {
 
         VK_CHECK_RESULT(vkAllocateCommandBuffers(mDevice, &cmdAllocInfo, &frame.mMainCommandBuffer));
 
-        mMainDeletionQueue.push_function([this, frame]() {
-            vkDestroyCommandPool(mDevice, frame.mCommandPool, nullptr);
-        });
+        mMainDeletionQueue.push(DeletionType::CommandPool, frame.mCommandPool);
     }
 
     VkCommandPoolCreateInfo uploadCommandPoolInfo = vkslime::command_pool_create_info(mGraphicsQueueFamily);
 //create pool for upload context
     VK_CHECK_RESULT(vkCreateCommandPool(mDevice, &uploadCommandPoolInfo, nullptr, &mUploadContext.mCommandPool));
 
-    mMainDeletionQueue.push_function([this]() {
-        vkDestroyCommandPool(mDevice, mUploadContext.mCommandPool, nullptr);
-    });
+    mMainDeletionQueue.push(DeletionType::CommandPool, mUploadContext.mCommandPool);
 
     //allocate the default command buffer that we will use for the instant commands
     VkCommandBufferAllocateInfo cmdAllocInfo = vkslime::command_buffer_allocate_info(mUploadContext.mCommandPool, 1);
@@ -267,36 +462,121 @@ void VulkanEngine::init_commands() {
 
 void VulkanEngine::cleanup() {
     if (mIsInitialized) {
+        mShaderReloader.cleanup();
+
         //make sure the GPU has stopped doing its things
         vkDeviceWaitIdle(mDevice);
 
-        mMainDeletionQueue.flush();
+        if (!mHeadless) {
+            ImGui_ImplVulkan_Shutdown();
+        }
+
+        mGpuProfiler.cleanup();
+
+        mTextureStreamer.cleanup();
+
+        mBindlessTextures.cleanup();
+
+        destroy_swapchain_resources();
+        if (mSwapchain != VK_NULL_HANDLE) {
+            vkDestroySwapchainKHR(mDevice, mSwapchain, nullptr);
+        }
+
+        //everything has retired, so deferred deletions can run straight away
+        mPendingDeletionQueue.flush(mDevice, mAllocator);
+        for (uint32_t i = 0; i < mFramesInFlight; i++) {
+            mFrames[i].mDeletionQueue.flush(mDevice, mAllocator);
+        }
+
+        for (auto &[key, pipeline]: mEffectPipelines) {
+            mMainDeletionQueue.push(DeletionType::Pipeline, pipeline);
+        }
+        mEffectPipelines.clear();
+
+        mMainDeletionQueue.flush(mDevice, mAllocator);
+        mShaderEffects.save_reflection_cache(SHADER_REFLECTION_CACHE_PATH);
+        mShaderEffects.cleanup();
 
-        vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+        mDescriptorAllocator.cleanup();
+        mDescriptorSetCache.cleanup();
+        mDescriptorLayoutCache.cleanup();
+
+        vmaDestroyAllocator(mAllocator);
+
+        if (mSurface != VK_NULL_HANDLE) {
+            vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+        }
 
         vkDestroyDevice(mDevice, nullptr);
         vkb::destroy_debug_utils_messenger(mInstance, mDebugMessenger);
         vkDestroyInstance(mInstance, nullptr);
 
-        SDL_DestroyWindow(mWindow);
+        if (mWindow != nullptr) {
+            SDL_DestroyWindow(mWindow);
+        }
     }
 }
 
 void VulkanEngine::draw() {
-    ImGui::Render();
+    ZoneScopedN("Draw")
 
-    //wait until the GPU has finished rendering the last frame. Timeout of 1 second
-    VK_CHECK_RESULT(vkWaitForFences(mDevice, 1, &get_current_frame().mRenderFence, true, 1000000000));
-    VK_CHECK_RESULT(vkResetFences(mDevice, 1, &get_current_frame().mRenderFence));
+    if (!mHeadless) {
+        ImGui::Render();
+    }
+
+    //resize or present mode change since the last frame, skip drawing while the window is minimized
+    if (mSwapchainDirty && !recreate_swapchain()) {
+        return;
+    }
+
+    //wait until the GPU has finished the last submission that used this frame's resources. A frame can take
+    //longer than the timeout on software devices or big headless captures, that only gets reported
+    while (!wait_for_timeline_value(get_current_frame().mTimelineValue)) {
+        Log::warn("Frame " + std::to_string(mFrameNumber) + " is still waiting on the GPU");
+    }
+
+    //that submission has retired, so whatever was queued for deletion alongside it can go now
+    get_current_frame().mDeletionQueue.flush(mDevice, mAllocator);
+    mBindlessTextures.collect(get_completed_timeline_value());
+
+    //between frames nothing is recording, so edited shaders swap in here
+    reload_changed_shaders();
+
+    //sets the cache hasn't handed out for a while are freed here, this frame's come back from it or are written new
+    mDescriptorSetCache.begin_frame((uint64_t) mFrameNumber);
+    build_frame_descriptors(get_current_frame());
+
+    const uint32_t frameIndex = (uint32_t) mFrameNumber % mFramesInFlight;
+    collect_gpu_timings(frameIndex);
 
     //now that we are sure that the commands finished executing, we can safely reset the command buffer to begin recording again.
     VK_CHECK_RESULT(vkResetCommandBuffer(get_current_frame().mMainCommandBuffer, 0));
 
-    //request image from the swapchain, one second timeout
     uint32_t swapchainImageIndex;
-    VK_CHECK_RESULT(
-            vkAcquireNextImageKHR(mDevice, mSwapchain, 1000000000, get_current_frame().mPresentSemaphore, nullptr,
-                                  &swapchainImageIndex));
+    if (mHeadless) {
+        //each frame owns its offscreen target, and the timeline wait above means it is free again
+        swapchainImageIndex = mFrameNumber % mFramesInFlight;
+    } else {
+        //request image from the swapchain, one second timeout
+        VkResult acquireResult;
+        {
+            ZoneScopedNC("Acquire Image", tracy::Color::Orange)
+            acquireResult = vkAcquireNextImageKHR(mDevice, mSwapchain, 1000000000,
+                                                  get_current_frame().mPresentSemaphore, nullptr,
+                                                  &swapchainImageIndex);
+        }
+
+        //the surface changed under us, nothing was acquired so rebuild and try again next frame
+        if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR) {
+            mSwapchainDirty = true;
+            return;
+        }
+        //a suboptimal image can still be presented, the swapchain is rebuilt after present
+        if (acquireResult != VK_SUBOPTIMAL_KHR) {
+            VK_CHECK_RESULT(acquireResult);
+        }
+    }
+    mLastImageIndex = swapchainImageIndex;
 
     //naming it cmd for shorter writing
     VkCommandBuffer cmd = get_current_frame().mMainCommandBuffer;
@@ -307,35 +587,69 @@ void VulkanEngine::draw() {
 
     VK_CHECK_RESULT(vkBeginCommandBuffer(cmd, &cmdBeginInfo));
 
-    //make a clear-color from frame number. This will flash with a 120*pi frame period.
-    VkClearValue clearValue;
-    clearValue.color = {{0.1f, 0.1f, 0.1f, 1.0f}};
+    mGpuProfiler.begin_frame(cmd, frameIndex, mFrameNumber);
+    {
+        //regions close when their scope ends, the frame region spans every pass
+        GpuProfileScope frameScope(mGpuProfiler, cmd, "Frame");
+
+        //uploads have to be recorded outside of the render pass, they use the demand of the last drawn frame
+        {
+            GpuProfileScope streamingScope(mGpuProfiler, cmd, "Texture Streaming");
+            mTextureStreamer.update(cmd, mFrameNumber, get_streaming_free_slots());
+        }
+        update_streamed_materials();
 
-    //clear depth at 1
-    VkClearValue depthClear;
-    depthClear.depthStencil.depth = 1.f;
+        //make a clear-color from frame number. This will flash with a 120*pi frame period.
+        VkClearValue clearValue;
+        clearValue.color = {{0.1f, 0.1f, 0.1f, 1.0f}};
 
-    //start the main renderpass.
-    //We will use the clear color from above, and the framebuffer of the index the swapchain gave us
-    VkRenderPassBeginInfo rpInfo = vkslime::renderpass_begin_info(mRenderPass, mWindowExtent,
-                                                                  mFramebuffers[swapchainImageIndex]);
+        //clear depth at 1
+        VkClearValue depthClear;
+        depthClear.depthStencil.depth = 1.f;
 
-    //connect clear values
-    rpInfo.clearValueCount = 2;
+        //start the main renderpass.
+        //We will use the clear color from above, and the framebuffer of the index the swapchain gave us
+        VkRenderPassBeginInfo rpInfo = vkslime::renderpass_begin_info(mRenderPass, mWindowExtent,
+                                                                      mFramebuffers[swapchainImageIndex]);
 
-    VkClearValue clearValues[] = {clearValue, depthClear};
+        //connect clear values
+        rpInfo.clearValueCount = 2;
 
-    rpInfo.pClearValues = &clearValues[0];
+        VkClearValue clearValues[] = {clearValue, depthClear};
 
-    vkCmdBeginRenderPass(cmd, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
+        rpInfo.pClearValues = &clearValues[0];
 
-    draw_objects(cmd, mRenderables.data(), (int) mRenderables.size());
+        GpuProfileScope mainPassScope(mGpuProfiler, cmd, "Main Pass");
+        vkCmdBeginRenderPass(cmd, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
 
+        //viewport and scissor are dynamic so pipelines survive swapchain recreation
+        VkViewport viewport = {};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = (float) mWindowExtent.width;
+        viewport.height = (float) mWindowExtent.height;
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(cmd, 0, 1, &viewport);
 
-    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd);
+        VkRect2D scissor = {};
+        scissor.offset = {0, 0};
+        scissor.extent = mWindowExtent;
+        vkCmdSetScissor(cmd, 0, 1, &scissor);
 
-    //finalize the render pass
-    vkCmdEndRenderPass(cmd);
+        {
+            GpuProfileScope objectsScope(mGpuProfiler, cmd, "Objects");
+            draw_objects(cmd, mRenderables.data(), (int) mRenderables.size());
+        }
+
+        if (!mHeadless) {
+            GpuProfileScope imguiScope(mGpuProfiler, cmd, "ImGui");
+            ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd);
+        }
+
+        //finalize the render pass
+        vkCmdEndRenderPass(cmd);
+    }
 
     //finalize the command buffer (we can no longer add commands, but it can now be executed)
     VK_CHECK_RESULT(vkEndCommandBuffer(cmd));
@@ -343,10 +657,22 @@ void VulkanEngine::draw() {
     //prepare the submission to the queue.
     //we want to wait on the _presentSemaphore, as that semaphore is signaled when the swapchain is ready
     //we will signal the _renderSemaphore, to signal that rendering has finished
+    //and bump the timeline so the CPU knows when this frame's resources can be reused
+    const uint64_t frameTimelineValue = ++mTimelineValue;
+
+    VkSemaphore signalSemaphores[] = {get_current_frame().mRenderSemaphore, mTimelineSemaphore};
+    //binary semaphores ignore their value
+    uint64_t signalValues[] = {0, frameTimelineValue};
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.pNext = nullptr;
+    timelineInfo.signalSemaphoreValueCount = 2;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
 
     VkSubmitInfo submit = {};
     submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit.pNext = nullptr;
+    submit.pNext = &timelineInfo;
 
     VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
@@ -355,14 +681,36 @@ void VulkanEngine::draw() {
     submit.waitSemaphoreCount = 1;
     submit.pWaitSemaphores = &get_current_frame().mPresentSemaphore;
 
-    submit.signalSemaphoreCount = 1;
-    submit.pSignalSemaphores = &get_current_frame().mRenderSemaphore;
+    submit.signalSemaphoreCount = 2;
+    submit.pSignalSemaphores = signalSemaphores;
+
+    //nothing is acquired or presented headless, only the timeline is signalled
+    if (mHeadless) {
+        submit.waitSemaphoreCount = 0;
+        submit.pWaitSemaphores = nullptr;
+
+        submit.signalSemaphoreCount = 1;
+        submit.pSignalSemaphores = &signalSemaphores[1];
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &signalValues[1];
+    }
 
     submit.commandBufferCount = 1;
     submit.pCommandBuffers = &cmd;
     //submit command buffer to the queue and execute it.
-    // _renderFence will now block until the graphic commands finish execution
-    VK_CHECK_RESULT(vkQueueSubmit(mGraphicsQueue, 1, &submit, get_current_frame().mRenderFence));
+    //waiting for frameTimelineValue will now block until the graphic commands finish execution
+    VK_CHECK_RESULT(vkQueueSubmit(mGraphicsQueue, 1, &submit, VK_NULL_HANDLE));
+    get_current_frame().mTimelineValue = frameTimelineValue;
+
+    //anything queued for deletion up to now may be referenced by this or an earlier submit,
+    //so it is released once this frame retires
+    get_current_frame().mDeletionQueue.append(mPendingDeletionQueue);
+
+    if (mHeadless) {
+        FrameMark;
+        mFrameNumber++;
+        return;
+    }
 
     // this will put the image we just rendered into the visible window.
     // we want to wait on the _renderSemaphore for that,
@@ -379,15 +727,31 @@ void VulkanEngine::draw() {
 
     presentInfo.pImageIndices = &swapchainImageIndex;
 
-    VK_CHECK_RESULT(vkQueuePresentKHR(mGraphicsQueue, &presentInfo));
+    VkResult presentResult;
+    {
+        ZoneScopedNC("Present", tracy::Color::Orange)
+        presentResult = vkQueuePresentKHR(mGraphicsQueue, &presentInfo);
+    }
+    if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR) {
+        mSwapchainDirty = true;
+    } else {
+        VK_CHECK_RESULT(presentResult);
+    }
 
     ImGui::EndFrame();
 
+    FrameMark;
+
     //increase the number of frames drawn
     mFrameNumber++;
 }
 
 void VulkanEngine::run() {
+    if (mHeadless) {
+        run_headless();
+        return;
+    }
+
     SDL_Event e;
     bool shouldClose = false;
 
@@ -399,17 +763,203 @@ void VulkanEngine::run() {
 
             //close the window when user clicks the X button or alt-f4s
             if (e.type == SDL_QUIT) shouldClose = true;
+
+            if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                mSwapchainDirty = true;
+            }
         }
 
         layer.draw(mWindow);
 
         ImGui::Begin("Scene", nullptr);
+
+        //switching present mode rebuilds the swapchain at the start of the next frame
+        const VkPresentModeKHR selectablePresentModes[] = {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR,
+                                                           VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+        if (ImGui::BeginCombo("Present Mode", vkslime::tools::presentModeString(mPresentMode).c_str())) {
+            for (VkPresentModeKHR presentMode: selectablePresentModes) {
+                if (ImGui::Selectable(vkslime::tools::presentModeString(presentMode).c_str(),
+                                      presentMode == mPresentMode)) {
+                    set_present_mode(presentMode);
+                }
+            }
+            ImGui::EndCombo();
+        }
+
         ImGui::End();
 
+        mGpuProfiler.draw_imgui();
+
+        mTextureStreamer.draw_imgui();
+
         draw();
     }
 }
 
+void VulkanEngine::run_benchmark(const BenchmarkConfig &config) {
+    CameraPath cameraPath = CameraPath::default_flythrough();
+
+    BenchmarkReport report;
+    report.mDeviceName = mGpuProperties.deviceName;
+    report.mMode = mHeadless ? "headless" : vkslime::tools::presentModeString(mPresentMode);
+    report.mWidth = mWindowExtent.width;
+    report.mHeight = mWindowExtent.height;
+    report.mWarmupFrames = config.warmupFrames;
+
+    if (!mGpuProfiler.is_supported()) {
+        Log::warn("GPU timestamps are not supported, the benchmark only reports CPU times");
+    }
+
+    mGpuFrameTimes.clear();
+    mRecordGpuFrameTimes = true;
+    mUseCameraOverride = true;
+
+    const uint32_t totalFrames = config.warmupFrames + config.frames;
+    Log::info("Benchmark: " + std::to_string(config.warmupFrames) + " warmup frames, " +
+              std::to_string(config.frames) + " measured frames");
+
+    SDL_Event e;
+    bool shouldClose = false;
+    auto frameStart = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < totalFrames && !shouldClose; i++) {
+        if (!mHeadless) {
+            while (SDL_PollEvent(&e) != 0) {
+                ImGui_ImplSDL2_ProcessEvent(&e);
+                if (e.type == SDL_QUIT) shouldClose = true;
+                if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                    mSwapchainDirty = true;
+                }
+            }
+
+            layer.draw(mWindow);
+        }
+
+        //the path is sampled by frame index, never by wall clock, so every run sees the same views
+        mCameraOverride = cameraPath.sample_view((float) i / (float) std::max(totalFrames - 1, 1u));
+
+        const int frameNumber = mFrameNumber;
+        draw();
+
+        //cpu frame time is start to start, so it includes waiting on the GPU and the present engine
+        auto frameEnd = std::chrono::steady_clock::now();
+        double cpuMs = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+        frameStart = frameEnd;
+
+        //a frame skipped for a swapchain rebuild did not advance the frame number and is not recorded
+        if (i >= config.warmupFrames && mFrameNumber != frameNumber) {
+            report.add_frame((uint64_t) frameNumber, cpuMs, mFrameStats.drawCalls, mFrameStats.triangles);
+        }
+    }
+
+    //collect the timestamps of the frames that were still in flight
+    vkDeviceWaitIdle(mDevice);
+    for (uint32_t i = 0; i < mFramesInFlight; i++) {
+        collect_gpu_timings(i);
+    }
+
+    for (const GpuFrameTime &gpuTime: mGpuFrameTimes) {
+        report.set_gpu_time((uint64_t) gpuTime.frameNumber, gpuTime.milliseconds);
+    }
+
+    mRecordGpuFrameTimes = false;
+    mUseCameraOverride = false;
+
+    TimingSummary cpu = report.cpu_summary();
+    TimingSummary gpu = report.gpu_summary();
+    Log::info("CPU ms p50 " + std::to_string(cpu.p50) + " p95 " + std::to_string(cpu.p95) + " p99 " +
+              std::to_string(cpu.p99));
+    Log::info("GPU ms p50 " + std::to_string(gpu.p50) + " p95 " + std::to_string(gpu.p95) + " p99 " +
+              std::to_string(gpu.p99));
+
+    if (report.write(config.outputPath)) {
+        Log::info("Wrote benchmark results to " + config.outputPath);
+    }
+}
+
+void VulkanEngine::run_headless() {
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < mHeadlessFrameCount; i++) {
+        draw();
+    }
+
+    vkDeviceWaitIdle(mDevice);
+
+    auto end = std::chrono::steady_clock::now();
+    auto time = std::chrono::duration<double>(end - start).count();
+    Log::info("Headless run: " + std::to_string(mHeadlessFrameCount) + " frames in " + std::to_string(time) +
+              " Seconds.");
+
+    if (!mHeadlessDumpPath.empty() && mHeadlessFrameCount > 0) {
+        dump_image(mLastImageIndex, mHeadlessDumpPath);
+    }
+}
+
+bool VulkanEngine::dump_image(uint32_t imageIndex, const std::string &path) {
+    const size_t pixelCount = (size_t) mWindowExtent.width * mWindowExtent.height;
+
+    AllocatedBufferUntyped readback = create_buffer(pixelCount * 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                    VMA_MEMORY_USAGE_GPU_TO_CPU);
+
+    VkImage image = mSwapchainImages[imageIndex];
+    VkExtent2D extent = mWindowExtent;
+    immediate_submit([=](VkCommandBuffer cmd) {
+        //the render pass left the image in transfer src layout, only the colour writes need to be made visible
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = 1;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkBufferImageCopy copyRegion = {};
+        copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copyRegion.imageSubresource.layerCount = 1;
+        copyRegion.imageExtent = {extent.width, extent.height, 1};
+
+        vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.mBuffer, 1, &copyRegion);
+    });
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        Log::error("Failed to open " + path + " for writing");
+        vmaDestroyBuffer(mAllocator, readback.mBuffer, readback.mAllocation);
+        return false;
+    }
+
+    const uint8_t *pixels;
+    vmaMapMemory(mAllocator, readback.mAllocation, (void **) &pixels);
+    vmaInvalidateAllocation(mAllocator, readback.mAllocation, 0, VK_WHOLE_SIZE);
+
+    //binary PPM, small enough to not need an image writing library. The targets are BGRA so swizzle to RGB
+    file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+    std::vector<uint8_t> row(extent.width * 3);
+    for (uint32_t y = 0; y < extent.height; y++) {
+        const uint8_t *src = pixels + (size_t) y * extent.width * 4;
+        for (uint32_t x = 0; x < extent.width; x++) {
+            row[x * 3 + 0] = src[x * 4 + 2];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 0];
+        }
+        file.write((const char *) row.data(), (std::streamsize) row.size());
+    }
+
+    vmaUnmapMemory(mAllocator, readback.mAllocation);
+    vmaDestroyBuffer(mAllocator, readback.mBuffer, readback.mAllocation);
+
+    Log::info("Wrote " + path);
+    return true;
+}
+
 void VulkanEngine::init_default_renderpass() {
     // the renderpass will use this color attachment.
     VkAttachmentDescription color_attachment = {};
@@ -428,8 +978,8 @@ void VulkanEngine::init_default_renderpass() {
     //we don't know or care about the starting layout of the attachment
     color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-    //after the renderpass ends, the image has to be on a layout ready for display
-    color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    //after the renderpass ends, the image has to be on a layout ready for display, or ready to be read back headless
+    color_attachment.finalLayout = mHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference color_attachment_ref = {};
     //attachment number will index into the pAttachments array in the parent renderpass itself
@@ -500,9 +1050,7 @@ void VulkanEngine::init_default_renderpass() {
 
     VK_CHECK_RESULT(vkCreateRenderPass(mDevice, &render_pass_info, nullptr, &mRenderPass));
 
-    mMainDeletionQueue.push_function([this]() {
-        vkDestroyRenderPass(mDevice, mRenderPass, nullptr);
-    });
+    mMainDeletionQueue.push(DeletionType::RenderPass, mRenderPass);
 }
 
 void VulkanEngine::init_framebuffers() {
@@ -521,133 +1069,138 @@ void VulkanEngine::init_framebuffers() {
         fb_info.pAttachments = attachments;
         fb_info.attachmentCount = 2;
         VK_CHECK_RESULT(vkCreateFramebuffer(mDevice, &fb_info, nullptr, &mFramebuffers[i]));
-
-        mMainDeletionQueue.push_function([this, i]() {
-            vkDestroyFramebuffer(mDevice, mFramebuffers[i], nullptr);
-            vkDestroyImageView(mDevice, mSwapchainImageViews[i], nullptr);
-        });
     }
 }
 
 void VulkanEngine::init_sync_structures() {
-    VkFenceCreateInfo uploadFenceCreateInfo = vkslime::fence_create_info();
-    VK_CHECK_RESULT(vkCreateFence(mDevice, &uploadFenceCreateInfo, nullptr, &mUploadContext.mUploadFence));
-    mMainDeletionQueue.push_function([this]() {
-        vkDestroyFence(mDevice, mUploadContext.mUploadFence, nullptr);
-    });
+    //one timeline semaphore replaces the per-frame and upload fences, it starts at 0 and only ever counts up
+    VkSemaphoreTypeCreateInfo timelineCreateInfo = {};
+    timelineCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineCreateInfo.pNext = nullptr;
+    timelineCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineCreateInfo.initialValue = 0;
 
-    VkFenceCreateInfo fenceCreateInfo = vkslime::fence_create_info(VK_FENCE_CREATE_SIGNALED_BIT);
+    VkSemaphoreCreateInfo timelineSemaphoreInfo = vkslime::semaphore_create_info();
+    timelineSemaphoreInfo.pNext = &timelineCreateInfo;
 
-    VkSemaphoreCreateInfo semaphoreCreateInfo = vkslime::semaphore_create_info();
+    VK_CHECK_RESULT(vkCreateSemaphore(mDevice, &timelineSemaphoreInfo, nullptr, &mTimelineSemaphore));
+    mMainDeletionQueue.push(DeletionType::Semaphore, mTimelineSemaphore);
 
-    for (auto &frame: mFrames) {
-
-        VK_CHECK_RESULT(vkCreateFence(mDevice, &fenceCreateInfo, nullptr, &frame.mRenderFence));
-
-        //enqueue the destruction of the fence
-        mMainDeletionQueue.push_function([this, &frame]() {
-            vkDestroyFence(mDevice, frame.mRenderFence, nullptr);
-        });
+    VkSemaphoreCreateInfo semaphoreCreateInfo = vkslime::semaphore_create_info();
 
+    for (uint32_t i = 0; i < mFramesInFlight; i++) {
+        FrameData &frame = mFrames[i];
 
         VK_CHECK_RESULT(vkCreateSemaphore(mDevice, &semaphoreCreateInfo, nullptr, &frame.mPresentSemaphore));
         VK_CHECK_RESULT(vkCreateSemaphore(mDevice, &semaphoreCreateInfo, nullptr, &frame.mRenderSemaphore));
 
         //enqueue the destruction of semaphores
-        mMainDeletionQueue.push_function([this, &frame]() {
-            vkDestroySemaphore(mDevice, frame.mPresentSemaphore, nullptr);
-            vkDestroySemaphore(mDevice, frame.mRenderSemaphore, nullptr);
-        });
+        mMainDeletionQueue.push(DeletionType::Semaphore, frame.mPresentSemaphore);
+        mMainDeletionQueue.push(DeletionType::Semaphore, frame.mRenderSemaphore);
     }
-}
-
 
-VkShaderModule VulkanEngine::load_shader_module(const char *filePath) {
-    //open the file. With cursor at the end
-    std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+    //the profiler's tracy context records a setup submit on the upload command buffer, so reset it afterwards
+    mGpuProfiler.init(mDevice, mChosenGPU, mGraphicsQueue, mGraphicsQueueFamily, mUploadContext.mCommandBuffer,
+                      mGpuProperties, mFramesInFlight, mMainDeletionQueue);
+    vkResetCommandPool(mDevice, mUploadContext.mCommandPool, 0);
+}
 
-    std::string fileName = fs::path(filePath).stem().generic_string();
 
-    if (!file.is_open()) {
-        return {};
+//push constants the shaders read past DrawPushConstants are never written, so they hold whatever was there.
+//usually means the SPIR-V is older than the struct
+static void check_push_constants(const std::string &effectName, const ShaderEffect &effect) {
+    for (const VkPushConstantRange &range: effect.pushConstantRanges) {
+        if (range.offset + range.size > sizeof(DrawPushConstants)) {
+            Log::warn("Shader effect " + effectName + " reads " + std::to_string(range.offset + range.size) +
+                      " bytes of push constants, only the first " + std::to_string(sizeof(DrawPushConstants)) +
+                      " are pushed per draw");
+        }
     }
+}
 
-//find what the size of the file is by looking up the location of the cursor
-//because the cursor is at the end, it gives the size directly in bytes
-    std::streamsize fileSize = file.tellg();
+bool VulkanEngine::init_pipeline() {
+    mShaderEffects.init(mDevice, &mDescriptorLayoutCache);
 
-//spirv expects the buffer to be on uint32, so make sure to reserve an int vector big enough for the entire file
-    std::vector<uint32_t> buffer(fileSize / sizeof(uint32_t));
+    //sets 0-2 are allocated and bound by the engine, every shader shares those layouts
+    mShaderEffects.set_fixed_layout(0, mGlobalSetLayout);
+    mShaderEffects.set_fixed_layout(1, mObjectSetLayout);
+    mShaderEffects.set_fixed_layout(2, mBindlessTextures.get_layout());
 
-//put file cursor at beginning
-    file.seekg(0);
+    //reflection of shaders that haven't changed since the last run is read back instead of redone
+    mShaderEffects.load_reflection_cache(SHADER_REFLECTION_CACHE_PATH);
 
-//load the entire file into the buffer
-    file.read((char *) buffer.data(), fileSize);
+    //the pipeline layout and push constant ranges come from reflecting the shaders
+    ShaderEffect *litEffect = mShaderEffects.get_effect("lit", {
+            {std::string(SHADER_DIRECTORY) + "lit.vert.spv", VK_SHADER_STAGE_VERTEX_BIT},
+            {std::string(SHADER_DIRECTORY) + "lit.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT}});
+    if (litEffect == nullptr) {
+        Log::error("Failed to load the lit shaders from " + std::string(SHADER_DIRECTORY));
+        return false;
+    }
+    check_push_constants("lit", *litEffect);
+    mShaderEffects.save_reflection_cache(SHADER_REFLECTION_CACHE_PATH);
 
-//now that the file is loaded into the buffer, we can close it
-    file.close();
+    //the empire texture is opaque and the mesh carries no useful colours, so the plainest variant does
+    Material *defaultMesh = create_material("lit", 0, std::string_view{"defaultMesh"});
+    if (defaultMesh->pipeline == VK_NULL_HANDLE) {
+        Log::error("Failed to build the lit pipeline");
+        return false;
+    }
+    return true;
+}
 
+//stages to push DrawPushConstants to. Every range covering the draw id has to be named in the push
+static VkShaderStageFlags draw_id_stages(const ShaderEffect &effect) {
+    VkShaderStageFlags stages = 0;
+    for (const VkPushConstantRange &range: effect.pushConstantRanges) {
+        if (range.offset < sizeof(DrawPushConstants)) {
+            stages |= range.stageFlags;
+        }
+    }
+    return stages;
+}
 
-//create a new shader module, using the buffer we loaded
-    VkShaderModuleCreateInfo createInfo = {};
-    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.pNext = nullptr;
+VkPipeline VulkanEngine::get_pipeline_variant(const std::string &effectName, ShaderFeatures features) {
+    auto key = std::make_pair(effectName, features);
+    auto it = mEffectPipelines.find(key);
+    if (it != mEffectPipelines.end()) {
+        return it->second;
+    }
 
-//codeSize has to be in bytes, so multiply the ints in the buffer by size of int to know the real size of the buffer
-    createInfo.codeSize = buffer.size() * sizeof(uint32_t);
-    createInfo.pCode = buffer.data();
+    ShaderEffect *effect = mShaderEffects.find_effect(effectName);
+    if (effect == nullptr) {
+        Log::error("No shader effect named " + effectName);
+        return VK_NULL_HANDLE;
+    }
 
-//check that the creation goes well.
-    VkShaderModule shaderModule;
-    if (vkCreateShaderModule(mDevice, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-        return {};
+    //usually SPIR-V compiled before the shader had the constants, the variant would silently draw without them
+    ShaderFeatures undeclared = features & ~effect->declared_features();
+    if (undeclared != 0) {
+        Log::warn("Shader effect " + effectName + " declares no specialization constant for features " +
+                  std::to_string(undeclared) + ", its variants with them draw like the ones without");
     }
-    mMainDeletionQueue.push_function([this, shaderModule]() {
-        vkDestroyShaderModule(mDevice, shaderModule, nullptr);
-    });
 
-    return shaderModule;
+    //destroyed on cleanup, or when a shader reload replaces it
+    VkPipeline pipeline = build_mesh_pipeline(effect, features);
+    if (pipeline != VK_NULL_HANDLE) {
+        mEffectPipelines[key] = pipeline;
+    }
+    return pipeline;
 }
 
-void VulkanEngine::init_pipeline() {
+VkPipeline VulkanEngine::build_mesh_pipeline(ShaderEffect *effect, ShaderFeatures features) {
     //build the stage-create-info for both vertex and fragment stages. This lets the pipeline know the shader modules per stage
     PipelineBuilder pipelineBuilder{};
+    ShaderVariantConstants variantConstants(features);
+    effect->fill_stages(pipelineBuilder.mShaderStages, &variantConstants.info);
 
-    pipelineBuilder.mShaderStages.push_back(
-            vkslime::pipeline_shader_stage_create_info(VK_SHADER_STAGE_VERTEX_BIT,
-                                                       load_shader_module("../Res/Shaders/lit.vert.spv")));
-
-    pipelineBuilder.mShaderStages.push_back(
-            vkslime::pipeline_shader_stage_create_info(VK_SHADER_STAGE_FRAGMENT_BIT,
-                                                       load_shader_module("../Res/Shaders/lit.frag.spv")));
-
-
-    //we start from just the default empty pipeline layout info
-    VkPipelineLayoutCreateInfo mesh_pipeline_layout_info = vkslime::pipeline_layout_create_info();
-
-    //setup push constants
-    VkPushConstantRange push_constant;
-    push_constant.offset = 0;
-    push_constant.size = sizeof(MeshPushConstants);
-    push_constant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-    mesh_pipeline_layout_info.pPushConstantRanges = &push_constant;
-    mesh_pipeline_layout_info.pushConstantRangeCount = 1;
-
-    VkDescriptorSetLayout setLayouts[] = {mGlobalSetLayout, mObjectSetLayout, mSingleTextureSetLayout};
-    mesh_pipeline_layout_info.setLayoutCount = 3;
-    mesh_pipeline_layout_info.pSetLayouts = setLayouts;
-
-    VkPipelineLayout meshPipLayout;
-    VK_CHECK_RESULT(vkCreatePipelineLayout(mDevice, &mesh_pipeline_layout_info, nullptr, &meshPipLayout));
-
-    //use the mesh layout we created
-    pipelineBuilder.mPipelineLayout = meshPipLayout;
+    //use the layout reflected from the shaders
+    pipelineBuilder.mPipelineLayout = effect->builtLayout;
     pipelineBuilder.mVertexInputInfo = vkslime::vertex_input_state_create_info();
     pipelineBuilder.mInputAssembly = vkslime::input_assembly_create_info(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
 
-    //build viewport and scissor from the swapchain extents
+    //build viewport and scissor from the swapchain extents, they are only placeholders as both are set dynamically
+    pipelineBuilder.mDynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
     pipelineBuilder.mViewport.x = 0.0f;
     pipelineBuilder.mViewport.y = 0.0f;
     pipelineBuilder.mViewport.width = (float) mWindowExtent.width;
@@ -675,18 +1228,54 @@ void VulkanEngine::init_pipeline() {
     pipelineBuilder.mVertexInputInfo.vertexBindingDescriptionCount = (int) vertexDescription.bindings.size();
 
 
-    VkPipeline meshPipeline = pipelineBuilder.build_pipeline(mDevice, mRenderPass);
-    create_material(meshPipeline, meshPipLayout, std::string_view{"defaultMesh"});
+    return pipelineBuilder.build_pipeline(mDevice, mRenderPass);
+}
 
-    mMainDeletionQueue.push_function([this, meshPipeline, meshPipLayout]() {
-        vkDestroyPipeline(mDevice, meshPipeline, nullptr);
+void VulkanEngine::reload_changed_shaders() {
+    std::vector<std::string> changed = mShaderReloader.take_changed();
+    if (changed.empty()) {
+        return;
+    }
 
-        //destroy the pipeline layout that they use
-        vkDestroyPipelineLayout(mDevice, meshPipLayout, nullptr);
-    });
+    ZoneScopedN("Shader Reload")
+
+    for (const std::string &name: mShaderEffects.reload_shaders(changed)) {
+        ShaderEffect *effect = mShaderEffects.find_effect(name);
+        check_push_constants(name, *effect);
+
+        //every variant built so far is rebuilt, the ones never asked for stay unbuilt
+        for (auto &[key, pipeline]: mEffectPipelines) {
+            if (key.first != name) {
+                continue;
+            }
+
+            VkPipeline newPipeline = build_mesh_pipeline(effect, key.second);
+            if (newPipeline == VK_NULL_HANDLE) {
+                //the old pipeline and its layout are still valid, keep drawing with them
+                Log::error("Failed to rebuild the pipeline for " + name + ", keeping the previous version");
+                continue;
+            }
+
+            for (auto &[materialName, material]: mMaterials) {
+                if (material.pipeline == pipeline) {
+                    material.pipeline = newPipeline;
+                    material.pipelineLayout = effect->builtLayout;
+                    material.drawIdStages = draw_id_stages(*effect);
+                }
+            }
+
+            //frames in flight may still be drawing with the old one
+            destroy_pipeline(pipeline);
+            pipeline = newPipeline;
+        }
+
+        Log::info("Reloaded shader effect " + name);
+    }
 }
 
 void VulkanEngine::load_meshes() {
+    ZoneScopedN("Load Meshes")
+
     std::string lostEmpirePath = std::string(
             mCurrentProjectPath + std::string("/../assets/Models/lost-empire/lost_empire.obj"));
     Mesh lostEmpire{};
@@ -698,6 +1287,8 @@ void VulkanEngine::load_meshes() {
 }
 
 void VulkanEngine::upload_mesh(Mesh &mesh) {
+    ZoneScopedNC("Upload Mesh", tracy::Color::Yellow)
+
     const size_t bufferSize = mesh.mVertices.size() * sizeof(Vertex);
     //allocate vertex buffer
     VkBufferCreateInfo stagingBufferInfo = {};
@@ -747,18 +1338,18 @@ void VulkanEngine::upload_mesh(Mesh &mesh) {
                                     &mesh.mVertexBuffer.mBuffer,
                                     &mesh.mVertexBuffer.mAllocation,
                                     nullptr));
-    //add the destruction of triangle mesh buffer to the deletion queue
-    mMainDeletionQueue.push_function([this, mesh]() {
-
-        vmaDestroyBuffer(mAllocator, mesh.mVertexBuffer.mBuffer, mesh.mVertexBuffer.mAllocation);
-    });
+    //add the destruction of triangle mesh buffer to the deletion queue.
+    //only the handles are recorded, the CPU-side vertices are not kept alive by the queue
+    mMainDeletionQueue.push_buffer(mesh.mVertexBuffer);
 
+    //capture the handles only, a by-value capture of mesh would copy every vertex into the closure
+    VkBuffer vertexBuffer = mesh.mVertexBuffer.mBuffer;
     immediate_submit([=](VkCommandBuffer cmd) {
         VkBufferCopy copy;
         copy.dstOffset = 0;
         copy.srcOffset = 0;
         copy.size = bufferSize;
-        vkCmdCopyBuffer(cmd, stagingBuffer.mBuffer, mesh.mVertexBuffer.mBuffer, 1, &copy);
+        vkCmdCopyBuffer(cmd, stagingBuffer.mBuffer, vertexBuffer, 1, &copy);
     });
 
     vmaDestroyBuffer(mAllocator, stagingBuffer.mBuffer, stagingBuffer.mAllocation);
@@ -787,6 +1378,13 @@ VkPipeline PipelineBuilder::build_pipeline(VkDevice device, VkRenderPass pass) {
     colorBlending.attachmentCount = 1;
     colorBlending.pAttachments = &mColorBlendAttachment;
 
+    //states listed here are set on the command buffer instead of being baked into the pipeline
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.pNext = nullptr;
+    dynamicState.dynamicStateCount = (uint32_t) mDynamicStates.size();
+    dynamicState.pDynamicStates = mDynamicStates.data();
+
     //build the actual pipeline
     //we now use all of the info structs we have been writing into into this one to create the pipeline
     VkGraphicsPipelineCreateInfo pipelineInfo = {};
@@ -802,6 +1400,7 @@ VkPipeline PipelineBuilder::build_pipeline(VkDevice device, VkRenderPass pass) {
     pipelineInfo.pMultisampleState = &mMultisampling;
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDepthStencilState = &mDepthStencil;
+    pipelineInfo.pDynamicState = mDynamicStates.empty() ? nullptr : &dynamicState;
     pipelineInfo.layout = mPipelineLayout;
     pipelineInfo.renderPass = pass;
     pipelineInfo.subpass = 0;
@@ -818,10 +1417,15 @@ VkPipeline PipelineBuilder::build_pipeline(VkDevice device, VkRenderPass pass) {
     }
 }
 
-Material *VulkanEngine::create_material(VkPipeline pipeline, VkPipelineLayout layout, const std::string_view &name) {
+Material *VulkanEngine::create_material(const std::string &effectName, ShaderFeatures features,
+                                        const std::string_view &name) {
     Material mat{};
-    mat.pipeline = pipeline;
-    mat.pipelineLayout = layout;
+    mat.pipeline = get_pipeline_variant(effectName, features);
+    if (ShaderEffect *effect = mShaderEffects.find_effect(effectName)) {
+        mat.pipelineLayout = effect->builtLayout;
+        mat.drawIdStages = draw_id_stages(*effect);
+    }
+    mat.features = features;
     mMaterials[name] = mat;
     return &mMaterials[name];
 }
@@ -846,16 +1450,38 @@ Mesh *VulkanEngine::get_mesh(const std::string &name) {
         return &(*it).second;
 }
 
+//pixels the object's bounding sphere spans on screen, infinite once the camera is inside it
+static float screen_coverage(const Mesh &mesh, const glm::mat4 &world, const glm::vec3 &cameraPosition,
+                             float projectionScale, float screenHeight) {
+    glm::vec3 center = world * glm::vec4(mesh.mBoundsOrigin, 1.0f);
+    float scale = std::max({glm::length(glm::vec3(world[0])),
+                            glm::length(glm::vec3(world[1])),
+                            glm::length(glm::vec3(world[2]))});
+    float radius = mesh.mBoundsRadius * scale;
+
+    float distance = glm::length(center - cameraPosition);
+    if (distance <= radius) {
+        return INFINITY;
+    }
+    return radius * std::abs(projectionScale) * screenHeight / distance;
+}
+
 void VulkanEngine::draw_objects(VkCommandBuffer cmd, RenderObject *first, int count) {
+    ZoneScopedN("Draw Objects")
+
     //Make a model view matrix for rendering the object
     // Camera view
     glm::vec3 camPos = {0.0f, -6.0f, glm::cos((float) (-mFrameNumber + -1000) * 0.001f) * 85.0f};
-    glm::mat4 view = glm::translate(glm::mat4{1.0f}, camPos);
+    glm::mat4 view = mUseCameraOverride ? mCameraOverride : glm::translate(glm::mat4{1.0f}, camPos);
 
     //Camera Projection
-    glm::mat4 projection = glm::perspective(glm::radians(70.0f), 1700.0f / 900.0f, 0.1f, 200.0f);
+    float aspect = (float) mWindowExtent.width / (float) mWindowExtent.height;
+    glm::mat4 projection = glm::perspective(glm::radians(70.0f), aspect, 0.1f, 200.0f);
     projection[1][1] *= -1; // Flip camera on UP axis
 
+    //world space camera position, for the texture streaming demand
+    glm::vec3 cameraPosition = glm::inverse(view)[3];
+
     //fill a GPU camera data struct
     GPUCameraData camData{};
     camData.proj = projection;
@@ -878,7 +1504,7 @@ void VulkanEngine::draw_objects(VkCommandBuffer cmd, RenderObject *first, int co
     char *sceneData;
     vmaMapMemory(mAllocator, mSceneParameterBuffer.mAllocation, (void **) &sceneData);
 
-    uint32_t frameIndex = static_cast<uint32_t>(mFrameNumber) % FRAME_OVERLAP;
+    uint32_t frameIndex = static_cast<uint32_t>(mFrameNumber) % mFramesInFlight;
 
     sceneData += pad_uniform_buffer_size(sizeof(GPUSceneData)) * frameIndex;
 
@@ -886,51 +1512,79 @@ void VulkanEngine::draw_objects(VkCommandBuffer cmd, RenderObject *first, int co
 
     vmaUnmapMemory(mAllocator, mSceneParameterBuffer.mAllocation);
 
+    mTransforms.update();
+
+    if (mTransforms.get_count() > MAX_OBJECTS && !mObjectOverflowReported) {
+        Log::warn(std::to_string(mTransforms.get_count()) + " transforms but the object buffer holds " +
+                  std::to_string(MAX_OBJECTS) + ", objects past that are not drawn");
+        mObjectOverflowReported = true;
+    }
+
     void *objectData;
     vmaMapMemory(mAllocator, get_current_frame().objectBuffer.mAllocation, &objectData);
 
     auto *objectSSBO = (GPUObjectData *) objectData;
 
+    //the buffer keeps its contents between frames, so only matrices that changed since it was last used are written
+    for (TransformId id: mTransforms.get_pending(frameIndex)) {
+        if (id < MAX_OBJECTS) {
+            objectSSBO[id].modelMatrix = mTransforms.get_world(id);
+        }
+    }
+    mTransforms.clear_pending(frameIndex);
+
+    //texture slots move as textures stream, 4 bytes per object is cheap enough to write every frame
     for (int i = 0; i < count; i++) {
         RenderObject const &object = first[i];
-        objectSSBO[i].modelMatrix = object.transformMatrix;
+        if (object.transform < MAX_OBJECTS) {
+            objectSSBO[object.transform].textureIndex = object.material->textureIndex;
+        }
     }
 
     vmaUnmapMemory(mAllocator, get_current_frame().objectBuffer.mAllocation);
 
+    mFrameStats = {};
+
     Mesh const *lastMesh = nullptr;
-    Material const *lastMaterial = nullptr;
+    VkPipeline lastPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout lastLayout = VK_NULL_HANDLE;
     for (int i = 0; i < count; ++i) {
         RenderObject &object = first[i];
+        if (object.transform >= MAX_OBJECTS) {
+            continue;
+        }
 
-        //only bind the pipeline if it doesn't math the already bound one
-        if (object.material != lastMaterial) {
-            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, object.material->pipeline);
-            lastMaterial = object.material;
+        //textures come from the object data, so materials sharing a pipeline don't rebind anything
+        if (object.material->pipelineLayout != lastLayout) {
+            lastLayout = object.material->pipelineLayout;
 
             //offset for our scene buffer
             uint32_t uniform_offset = pad_uniform_buffer_size(sizeof(GPUSceneData)) * frameIndex;
-            //bind the descriptor set when changing pipeline
-            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, object.material->pipelineLayout, 0, 1,
-                                    &get_current_frame().globalDescriptor, 1, &uniform_offset);
-
-            //object data descriptor
-            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, object.material->pipelineLayout, 1, 1,
-                                    &get_current_frame().objectDescriptor, 0, nullptr);
-
-            if (object.material->textureSet != VK_NULL_HANDLE) {
-                //texture descriptor
-                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, object.material->pipelineLayout, 2, 1,
-                                        &object.material->textureSet, 0, nullptr);
-            }
+            VkDescriptorSet sets[] = {get_current_frame().globalDescriptor, get_current_frame().objectDescriptor,
+                                      mBindlessTextures.get_set()};
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, lastLayout, 0, 3, sets, 1,
+                                    &uniform_offset);
+        }
+
+        //only bind the pipeline if it doesn't math the already bound one
+        if (object.material->pipeline != lastPipeline) {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, object.material->pipeline);
+            lastPipeline = object.material->pipeline;
         }
 
-        MeshPushConstants constants{};
-        constants.renderMatrix = object.transformMatrix;
+        if (object.material->streamedTexture != INVALID_STREAMED_TEXTURE) {
+            mTextureStreamer.request(object.material->streamedTexture,
+                                     screen_coverage(*object.mesh, mTransforms.get_world(object.transform),
+                                                     cameraPosition, projection[1][1],
+                                                     (float) mWindowExtent.height));
+        }
 
-        //Upload the mesh to the GPU via push constants
-        vkCmdPushConstants(cmd, object.material->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
-                           sizeof(MeshPushConstants), &constants);
+        //the model matrix is already in the object buffer, only shaders that asked for a draw id get one
+        if (object.material->drawIdStages != 0) {
+            DrawPushConstants constants{object.transform};
+            vkCmdPushConstants(cmd, object.material->pipelineLayout, object.material->drawIdStages, 0,
+                               sizeof(DrawPushConstants), &constants);
+        }
 
         //only bind mesh if it's a diffrent one from last bind
         if (object.mesh != lastMesh) {
@@ -940,7 +1594,10 @@ void VulkanEngine::draw_objects(VkCommandBuffer cmd, RenderObject *first, int co
             lastMesh = object.mesh;
         }
         //We can now draw
-        vkCmdDraw(cmd, (uint32_t) object.mesh->mVertices.size(), 1, 0, i);
+        vkCmdDraw(cmd, (uint32_t) object.mesh->mVertices.size(), 1, 0, object.transform);
+
+        mFrameStats.drawCalls++;
+        mFrameStats.triangles += object.mesh->mVertices.size() / 3;
     }
 
 }
@@ -950,8 +1607,7 @@ void VulkanEngine::init_scene() {
     map.mesh = get_mesh("empire");
     map.material = get_material("defaultMesh");
 
-    glm::mat4 translation = glm::translate(glm::mat4{1.0f}, glm::vec3{5, -10, 0});
-    map.transformMatrix = translation;
+    map.transform = mTransforms.create(glm::vec3{5, -10, 0});
 
     mRenderables.push_back(map);
 
@@ -961,36 +1617,63 @@ void VulkanEngine::init_scene() {
     VkSampler blockySampler;
     vkCreateSampler(mDevice, &samplerInfo, nullptr, &blockySampler);
 
-    mMainDeletionQueue.push_function([this, blockySampler]() {
-        vkDestroySampler(mDevice, blockySampler, nullptr);
-    });
+    mMainDeletionQueue.push(DeletionType::Sampler, blockySampler);
 
     Material *texturedMat = get_material("defaultMesh");
+    const Texture &empireDiffuse = mLoadedTextures["empire_diffuse"];
+
+    texturedMat->textureSampler = blockySampler;
+    if (empireDiffuse.streamed != INVALID_STREAMED_TEXTURE) {
+        //update_streamed_materials gives it a slot holding whatever is resident
+        texturedMat->streamedTexture = empireDiffuse.streamed;
+        mTextureStreamer.add_slot_user(empireDiffuse.streamed);
+        update_streamed_materials();
+    } else {
+        texturedMat->textureIndex = mBindlessTextures.add(empireDiffuse.imageView, blockySampler);
+    }
+}
 
-    //allocate the descriptor set for single-texture to use on the material
-    VkDescriptorSetAllocateInfo allocInfo = {};
-    allocInfo.pNext = nullptr;
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = mDescriptorPool;
-    allocInfo.descriptorSetCount = 1;
-    allocInfo.pSetLayouts = &mSingleTextureSetLayout;
+void VulkanEngine::update_streamed_materials() {
+    for (auto &[name, material]: mMaterials) {
+        if (material.streamedTexture == INVALID_STREAMED_TEXTURE) {
+            continue;
+        }
 
-    vkAllocateDescriptorSets(mDevice, &allocInfo, &texturedMat->textureSet);
+        uint32_t version = mTextureStreamer.get_version(material.streamedTexture);
+        if (material.textureIndex != INVALID_BINDLESS_TEXTURE && material.textureVersion == version) {
+            continue;
+        }
 
-    //write to the descriptor set so that it points to our empire_diffuse texture
-    VkDescriptorImageInfo imageBufferInfo;
-    imageBufferInfo.sampler = blockySampler;
-    imageBufferInfo.imageView = mLoadedTextures["empire_diffuse"].imageView;
-    imageBufferInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        BindlessTextureIndex index = mBindlessTextures.add(mTextureStreamer.get_view(material.streamedTexture),
+                                                           material.textureSampler);
+        if (index == INVALID_BINDLESS_TEXTURE) {
+            //the streamer reserves slots before replacing an image, so only a material that never got its first
+            //slot ends up here. It stays unset and tries again next frame
+            assert(material.textureIndex == INVALID_BINDLESS_TEXTURE);
+            Log::warn("Bindless texture table full, material " + std::string(name) + " has no texture yet");
+            continue;
+        }
 
-    VkWriteDescriptorSet texture1 = vkslime::write_descriptor_image(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                                                                    texturedMat->textureSet, &imageBufferInfo, 0);
+        //submitted frames may still read the old slot, the one being recorded already uses the new one
+        mBindlessTextures.release(material.textureIndex, mTimelineValue);
+        material.textureIndex = index;
+        material.textureVersion = version;
+    }
+}
 
-    vkUpdateDescriptorSets(mDevice, 1, &texture1, 0, nullptr);
+uint32_t VulkanEngine::get_streaming_free_slots() const {
+    uint32_t freeSlots = mBindlessTextures.get_capacity() - mBindlessTextures.get_used();
+    for (const auto &[name, material]: mMaterials) {
+        if (material.streamedTexture != INVALID_STREAMED_TEXTURE &&
+            material.textureIndex == INVALID_BINDLESS_TEXTURE && freeSlots > 0) {
+            freeSlots--;
+        }
+    }
+    return freeSlots;
 }
 
 FrameData &VulkanEngine::get_current_frame() {
-    return mFrames[mFrameNumber % FRAME_OVERLAP];
+    return mFrames[mFrameNumber % mFramesInFlight];
 }
 
 AllocatedBufferUntyped
@@ -1021,24 +1704,12 @@ VulkanEngine::create_buffer(size_t allocSize, VkBufferUsageFlags usage, VmaMemor
 }
 
 void VulkanEngine::init_descriptors() {
-    //create a descriptor pool that will hold 10 uniform buffers
-    std::vector<VkDescriptorPoolSize> sizes =
-            {
-                    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         10},
-                    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 10},
-                    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         10},
-                    //add combined-image-sampler descriptor types to the pool
-                    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 10}
-            };
-
-    VkDescriptorPoolCreateInfo pool_info = {};
-    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    pool_info.flags = 0;
-    pool_info.maxSets = 10;
-    pool_info.poolSizeCount = (uint32_t) sizes.size();
-    pool_info.pPoolSizes = sizes.data();
-
-    vkCreateDescriptorPool(mDevice, &pool_info, nullptr, &mDescriptorPool);
+    //long lived sets come from mDescriptorAllocator, which grows by another pool when it runs out instead of
+    //failing at a fixed size. Per frame sets come from the descriptor set cache
+    mDescriptorLayoutCache.init(mDevice);
+    mDescriptorAllocator.init(mDevice);
+    //sets whose contents repeat between frames are reused from here, kept a second after their last use
+    mDescriptorSetCache.init(mDevice, std::max(mFramesInFlight, 120u));
 
     VkDescriptorSetLayoutBinding cameraBind = vkslime::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
                                                                                     VK_SHADER_STAGE_VERTEX_BIT, 0);
@@ -1054,7 +1725,7 @@ void VulkanEngine::init_descriptors() {
     setinfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     setinfo.pBindings = bindings;
 
-    vkCreateDescriptorSetLayout(mDevice, &setinfo, nullptr, &mGlobalSetLayout);
+    mGlobalSetLayout = mDescriptorLayoutCache.create_descriptor_layout(&setinfo);
 
     VkDescriptorSetLayoutBinding objectBind = vkslime::descriptorset_layout_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                                                                                     VK_SHADER_STAGE_VERTEX_BIT, 0);
@@ -1066,7 +1737,7 @@ void VulkanEngine::init_descriptors() {
     set2info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     set2info.pBindings = &objectBind;
 
-    vkCreateDescriptorSetLayout(mDevice, &set2info, nullptr, &mObjectSetLayout);
+    mObjectSetLayout = mDescriptorLayoutCache.create_descriptor_layout(&set2info);
 
     VkDescriptorSetLayoutBinding textureBind = vkslime::descriptorset_layout_binding(
             VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 0);
@@ -1078,88 +1749,69 @@ void VulkanEngine::init_descriptors() {
     set3info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     set3info.pBindings = &textureBind;
 
-    vkCreateDescriptorSetLayout(mDevice, &set3info, nullptr, &mSingleTextureSetLayout);
+    mSingleTextureSetLayout = mDescriptorLayoutCache.create_descriptor_layout(&set3info);
+
+    mBindlessTextures.init(mDevice, mChosenGPU, MAX_BINDLESS_TEXTURES);
 
 
-    const size_t sceneParamBufferSize = FRAME_OVERLAP * pad_uniform_buffer_size(sizeof(GPUSceneData));
+    const size_t sceneParamBufferSize = mFramesInFlight * pad_uniform_buffer_size(sizeof(GPUSceneData));
 
     mSceneParameterBuffer = create_buffer(sceneParamBufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                                           VMA_MEMORY_USAGE_CPU_TO_GPU);
 
-    for (auto &frame: mFrames) {
+    for (uint32_t i = 0; i < mFramesInFlight; i++) {
+        FrameData &frame = mFrames[i];
         frame.cameraBuffer = create_buffer(sizeof(GPUCameraData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                                            VMA_MEMORY_USAGE_CPU_TO_GPU);
 
-        const int MAX_OBJECTS = 10000;
         frame.objectBuffer = create_buffer(sizeof(GPUObjectData) * MAX_OBJECTS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
                                            VMA_MEMORY_USAGE_CPU_TO_GPU);
+    }
 
-        VkDescriptorSetAllocateInfo allocInfo = {};
-        allocInfo.pNext = nullptr;
-        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocInfo.descriptorPool = mDescriptorPool;
-        allocInfo.descriptorSetCount = 1;
-        allocInfo.pSetLayouts = &mGlobalSetLayout;
-
-        vkAllocateDescriptorSets(mDevice, &allocInfo, &frame.globalDescriptor);
-
-        VkDescriptorSetAllocateInfo objectSetAlloc = {};
-        objectSetAlloc.pNext = nullptr;
-        objectSetAlloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        objectSetAlloc.descriptorPool = mDescriptorPool;
-        objectSetAlloc.descriptorSetCount = 1;
-        objectSetAlloc.pSetLayouts = &mObjectSetLayout;
+    //every frame's object buffer gets each changed world matrix once
+    mTransforms.set_consumer_count(mFramesInFlight);
 
-        vkAllocateDescriptorSets(mDevice, &objectSetAlloc, &frame.objectDescriptor);
+    mMainDeletionQueue.push_buffer(mSceneParameterBuffer);
 
-        VkDescriptorBufferInfo cameraInfo;
-        cameraInfo.buffer = frame.cameraBuffer.mBuffer;
-        cameraInfo.offset = 0;
-        cameraInfo.range = sizeof(GPUCameraData);
+    for (uint32_t i = 0; i < mFramesInFlight; i++) {
+        mMainDeletionQueue.push_buffer(mFrames[i].cameraBuffer);
+        mMainDeletionQueue.push_buffer(mFrames[i].objectBuffer);
+    }
 
-        VkDescriptorBufferInfo sceneInfo;
-        sceneInfo.buffer = mSceneParameterBuffer.mBuffer;
-        sceneInfo.offset = 0;
-        sceneInfo.range = sizeof(GPUSceneData);
+}
 
-        VkDescriptorBufferInfo objectBufferInfo;
-        objectBufferInfo.buffer = frame.objectBuffer.mBuffer;
-        objectBufferInfo.offset = 0;
-        objectBufferInfo.range = sizeof(GPUObjectData) * MAX_OBJECTS;
+void VulkanEngine::build_frame_descriptors(FrameData &frame) {
+    ZoneScopedN("Build Frame Descriptors")
 
+    VkDescriptorBufferInfo cameraInfo;
+    cameraInfo.buffer = frame.cameraBuffer.mBuffer;
+    cameraInfo.offset = 0;
+    cameraInfo.range = sizeof(GPUCameraData);
 
-        VkWriteDescriptorSet cameraWrite = vkslime::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                                                                            frame.globalDescriptor, &cameraInfo, 0);
+    VkDescriptorBufferInfo sceneInfo;
+    sceneInfo.buffer = mSceneParameterBuffer.mBuffer;
+    sceneInfo.offset = 0;
+    sceneInfo.range = sizeof(GPUSceneData);
 
-        VkWriteDescriptorSet sceneWrite = vkslime::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
-                                                                           frame.globalDescriptor, &sceneInfo, 1);
+    VkDescriptorBufferInfo objectBufferInfo;
+    objectBufferInfo.buffer = frame.objectBuffer.mBuffer;
+    objectBufferInfo.offset = 0;
+    objectBufferInfo.range = frame.objectBuffer.mSize;
 
-        VkWriteDescriptorSet objectWrite = vkslime::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                                                            frame.objectDescriptor, &objectBufferInfo,
-                                                                            0);
+    //the buffers never change, so after the first use of each frame slot these are cache hits
+    VkWriteDescriptorSet globalWrites[] = {
+            vkslime::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_NULL_HANDLE, &cameraInfo, 0),
+            vkslime::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_NULL_HANDLE, &sceneInfo, 1)
+    };
+    bool built = mDescriptorSetCache.get(mGlobalSetLayout, globalWrites, 2, frame.globalDescriptor);
 
-        VkWriteDescriptorSet setWrites[] = {cameraWrite, sceneWrite, objectWrite};
+    VkWriteDescriptorSet objectWrite = vkslime::write_descriptor_buffer(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                                                        VK_NULL_HANDLE, &objectBufferInfo, 0);
+    built &= mDescriptorSetCache.get(mObjectSetLayout, &objectWrite, 1, frame.objectDescriptor);
 
-        vkUpdateDescriptorSets(mDevice, 3, setWrites, 0, nullptr);
+    if (!built) {
+        Log::error("Failed to allocate the frame descriptor sets");
     }
-
-    mMainDeletionQueue.push_function([this]() {
-
-        vmaDestroyBuffer(mAllocator, mSceneParameterBuffer.mBuffer, mSceneParameterBuffer.mAllocation);
-
-        vkDestroyDescriptorSetLayout(mDevice, mObjectSetLayout, nullptr);
-        vkDestroyDescriptorSetLayout(mDevice, mGlobalSetLayout, nullptr);
-        vkDestroyDescriptorSetLayout(mDevice, mSingleTextureSetLayout, nullptr);
-
-        vkDestroyDescriptorPool(mDevice, mDescriptorPool, nullptr);
-
-        for (auto &frame: mFrames) {
-            vmaDestroyBuffer(mAllocator, frame.cameraBuffer.mBuffer, frame.cameraBuffer.mAllocation);
-
-            vmaDestroyBuffer(mAllocator, frame.objectBuffer.mBuffer, frame.objectBuffer.mAllocation);
-        }
-    });
-
 }
 
 size_t VulkanEngine::pad_uniform_buffer_size(size_t originalSize) const {
@@ -1173,6 +1825,8 @@ size_t VulkanEngine::pad_uniform_buffer_size(size_t originalSize) const {
 }
 
 void VulkanEngine::immediate_submit(std::function<void(VkCommandBuffer cmd)> &&function) {
+    ZoneScopedNC("Immediate Submit", tracy::Color::Yellow)
+
     VkCommandBuffer cmd = mUploadContext.mCommandBuffer;
 
     //begin the command buffer recording. We will use this command buffer exactly once before resetting, so we tell vulkan that
@@ -1186,34 +1840,104 @@ void VulkanEngine::immediate_submit(std::function<void(VkCommandBuffer cmd)> &&f
 
     VK_CHECK_RESULT(vkEndCommandBuffer(cmd));
 
-    VkSubmitInfo submit = vkslime::submit_info(&cmd);
+    //uploads signal the same timeline as frames, so they need no fence of their own
+    const uint64_t uploadTimelineValue = ++mTimelineValue;
 
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.pNext = nullptr;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &uploadTimelineValue;
+
+    VkSubmitInfo submit = vkslime::submit_info(&cmd);
+    submit.pNext = &timelineInfo;
+    submit.signalSemaphoreCount = 1;
+    submit.pSignalSemaphores = &mTimelineSemaphore;
 
     //submit command buffer to the queue and execute it.
-    // _uploadFence will now block until the graphic commands finish execution
-    VK_CHECK_RESULT(vkQueueSubmit(mGraphicsQueue, 1, &submit, mUploadContext.mUploadFence));
+    //waiting for uploadTimelineValue will now block until the graphic commands finish execution
+    VK_CHECK_RESULT(vkQueueSubmit(mGraphicsQueue, 1, &submit, VK_NULL_HANDLE));
 
-    vkWaitForFences(mDevice, 1, &mUploadContext.mUploadFence, true, 9999999999);
-    vkResetFences(mDevice, 1, &mUploadContext.mUploadFence);
+    //an upload can take far longer than a frame on slow or software devices, so wait for it without a timeout
+    wait_for_timeline_value(uploadTimelineValue, UINT64_MAX);
 
     // reset the command buffers inside the command pool
     vkResetCommandPool(mDevice, mUploadContext.mCommandPool, 0);
 }
 
+uint64_t VulkanEngine::get_completed_timeline_value() const {
+    uint64_t value = 0;
+    VK_CHECK_RESULT(vkGetSemaphoreCounterValue(mDevice, mTimelineSemaphore, &value));
+    return value;
+}
+
+bool VulkanEngine::wait_for_timeline_value(uint64_t value, uint64_t timeout) const {
+    ZoneScopedNC("Wait Timeline", tracy::Color::Red)
+
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.pNext = nullptr;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &mTimelineSemaphore;
+    waitInfo.pValues = &value;
+
+    VkResult result = vkWaitSemaphores(mDevice, &waitInfo, timeout);
+    if (result == VK_TIMEOUT) {
+        return false;
+    }
+    VK_CHECK_RESULT(result);
+    return true;
+}
+
+void VulkanEngine::collect_gpu_timings(uint32_t frameIndex) {
+    if (!mGpuProfiler.collect(frameIndex)) {
+        return;
+    }
+
+    //the first region is always the whole frame
+    const std::vector<GpuRegionTiming> &timings = mGpuProfiler.get_timings();
+    if (mRecordGpuFrameTimes && !timings.empty()) {
+        mGpuFrameTimes.push_back({mGpuProfiler.get_timings_frame(), timings.front().milliseconds});
+    }
+}
+
+void VulkanEngine::destroy_buffer(const AllocatedBufferUntyped &buffer) {
+    mPendingDeletionQueue.push_buffer(buffer);
+}
+
+void VulkanEngine::destroy_image(const AllocatedImage &image) {
+    mPendingDeletionQueue.push_image(image);
+}
+
+void VulkanEngine::destroy_pipeline(VkPipeline pipeline) {
+    mPendingDeletionQueue.push(DeletionType::Pipeline, pipeline);
+}
+
+void VulkanEngine::destroy_descriptor_pool(VkDescriptorPool pool) {
+    mPendingDeletionQueue.push(DeletionType::DescriptorPool, pool);
+}
+
 void VulkanEngine::load_images() {
     //load_image_to_cache("empire_diffuse", "/../assets/Models/lost-empire/lost_empire-RGBA.png");
 
     Texture lostEmpire{};
-    std::string lostEmpireImagePath = mCurrentProjectPath + "/../assets/Models/lost-empire/lost_empire-RGBA.png";
-    vkutil::load_image_from_file(*this, lostEmpireImagePath.c_str(), lostEmpire.image);
 
-    VkImageViewCreateInfo imageinfo = vkslime::imageview_create_info(VK_FORMAT_R8G8B8A8_SRGB, lostEmpire.image.mImage,
-                                                                     VK_IMAGE_ASPECT_COLOR_BIT);
-    vkCreateImageView(mDevice, &imageinfo, nullptr, &lostEmpire.imageView);
+    //a texture baked by slime_baker carries its mip chain and is streamed, the png is only a single level fallback
+    std::string lostEmpireAssetPath = mCurrentProjectPath + "/../assets/Models/lost-empire/lost_empire-RGBA.tx";
+    if (std::filesystem::exists(lostEmpireAssetPath)) {
+        lostEmpire.streamed = mTextureStreamer.add_texture(lostEmpireAssetPath);
+    }
+    if (lostEmpire.streamed == INVALID_STREAMED_TEXTURE) {
+        std::string lostEmpireImagePath = mCurrentProjectPath + "/../assets/Models/lost-empire/lost_empire-RGBA.png";
+        vkutil::load_image_from_file(*this, lostEmpireImagePath.c_str(), lostEmpire.image);
 
-    mMainDeletionQueue.push_function([this, lostEmpire]() {
-        vkDestroyImageView(mDevice, lostEmpire.imageView, nullptr);
-    });
+        VkImageViewCreateInfo imageinfo = vkslime::imageview_create_info(VK_FORMAT_R8G8B8A8_SRGB,
+                                                                         lostEmpire.image.mImage,
+                                                                         VK_IMAGE_ASPECT_COLOR_BIT);
+        vkCreateImageView(mDevice, &imageinfo, nullptr, &lostEmpire.imageView);
+
+        mMainDeletionQueue.push(DeletionType::ImageView, lostEmpire.imageView);
+    }
 
 
     mLoadedTextures["empire_diffuse"] = lostEmpire;
@@ -1284,19 +2008,16 @@ void VulkanEngine::init_imgui() {
     //clear font textures from cpu data
     ImGui_ImplVulkan_DestroyFontUploadObjects();
 
-    //add the destroy the imgui created structures
-    mMainDeletionQueue.push_function([this, imguiPool]() {
-        vkDestroyDescriptorPool(mDevice, imguiPool, nullptr);
-        ImGui_ImplVulkan_Shutdown();
-    });
+    //add the destroy the imgui created structures, ImGui_ImplVulkan_Shutdown runs in cleanup before the queue is flushed
+    mMainDeletionQueue.push(DeletionType::DescriptorPool, imguiPool);
 }
 
 ImTextureID VulkanEngine::AddTexture(VkImageLayout imageLayout, VkImageView imageView, VkSampler sampler) {
-    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = vkslime::descriptor_set_allocate_info(mDescriptorPool,
-                                                                                                  mSingleTextureSetLayout);
-
     VkDescriptorSet textureDescriptorSet = VkDescriptorSet();
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(mDevice, &descriptorSetAllocateInfo, &textureDescriptorSet));
+    if (!mDescriptorAllocator.allocate(&textureDescriptorSet, mSingleTextureSetLayout)) {
+        Log::error("Failed to allocate an ImGui texture descriptor set");
+        return nullptr;
+    }
 
     VkDescriptorImageInfo descriptorImageInfo = VkDescriptorImageInfo();
     descriptorImageInfo.imageLayout = imageLayout;
@@ -1315,8 +2036,8 @@ ImTextureID VulkanEngine::AddTexture(VkImageLayout imageLayout, VkImageView imag
 }
 
 bool VulkanEngine::load_image_to_cache(const char *name, const char *path) {
+    ZoneScopedNC("Load Texture", tracy::Color::Yellow)
 
-    //ZoneScopedNC("Load Texture", tracy::Color::Yellow);
     Texture newtex{};
 
     if (mLoadedTextures.find(name) != mLoadedTextures.end()) return true;
@@ -8,14 +8,22 @@
 #include "VulkanMesh.h"
 #include "VulkanShaders.h"
 #include "VulkanTools.h"
+#include "VulkanDeletionQueue.h"
+#include "VulkanDescriptors.h"
+#include "VulkanProfiler.h"
+#include "VulkanTextureStreaming.h"
+#include "VulkanBindless.h"
+#include "VulkanShaderReload.h"
+#include "TransformSystem.h"
 
 #include "ImGuiLayer.h"
+#include "Benchmark.h"
 
 #include <vector>
 #include <functional>
-#include <deque>
 #include <memory>
 #include <unordered_map>
+#include <map>
 
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
@@ -25,14 +33,32 @@
 #include "Log.h"
 
 struct Material {
-    VkDescriptorSet textureSet{VK_NULL_HANDLE};
     VkPipeline pipeline = VK_NULL_HANDLE;
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+
+    //what the material needs from its shaders, pipeline is the variant with exactly these features
+    ShaderFeatures features{0};
+
+    //stages whose reflected push constants start with DrawPushConstants. 0 means the shaders declare none and
+    //nothing is pushed per draw
+    VkShaderStageFlags drawIdStages{0};
+
+    //slot of the material's texture in the bindless table, written into the object data of everything using it
+    BindlessTextureIndex textureIndex{INVALID_BINDLESS_TEXTURE};
+
+    //a streamed texture swaps its image while frames are in flight, so every new image takes a new slot
+    //and the old one is released once the frames that could read it have retired
+    StreamedTextureId streamedTexture{INVALID_STREAMED_TEXTURE};
+    VkSampler textureSampler{VK_NULL_HANDLE};
+    uint32_t textureVersion{0};
 };
 
 struct Texture {
     AllocatedImage image;
     VkImageView imageView;
+
+    //set when the texture is owned by the streamer, image and imageView are then unused
+    StreamedTextureId streamed{INVALID_STREAMED_TEXTURE};
 };
 
 struct RenderObject {
@@ -40,7 +66,9 @@ struct RenderObject {
 
     Material *material;
 
-    glm::mat4 transformMatrix;
+    //world matrix lives in the engine's TransformSystem. Also the object's index in the object buffer, so every
+    //render object needs its own transform
+    TransformId transform{INVALID_TRANSFORM};
 };
 
 struct GPUCameraData {
@@ -52,7 +80,12 @@ struct GPUCameraData {
 struct FrameData {
     VkSemaphore mPresentSemaphore;
     VkSemaphore mRenderSemaphore;
-    VkFence mRenderFence;
+
+    //value the engine timeline semaphore reaches once this frame's commands have finished on the GPU
+    uint64_t mTimelineValue{0};
+
+    //resources released once this frame has retired on the GPU
+    DeletionQueue mDeletionQueue;
 
     VkCommandPool mCommandPool; //the command pool for our commands
     VkCommandBuffer mMainCommandBuffer; //the buffer we will record into
@@ -61,20 +94,21 @@ struct FrameData {
     AllocatedBufferUntyped cameraBuffer;
     AllocatedBufferUntyped objectBuffer;
 
+    //fetched from the engine's descriptor set cache every frame
     VkDescriptorSet globalDescriptor;
     VkDescriptorSet objectDescriptor;
 
 };
 
 struct UploadContext {
-    VkFence mUploadFence;
     VkCommandPool mCommandPool;
     VkCommandBuffer mCommandBuffer;
 };
 
-struct MeshPushConstants {
-    glm::vec4 data;
-    glm::mat4 renderMatrix;
+//the only per draw data pushed. Shaders read everything else from the object buffer, indexed with this or with
+//gl_BaseInstance, which the draw sets to the same value
+struct DrawPushConstants {
+    uint32_t drawId;
 };
 
 struct GPUSceneData {
@@ -87,23 +121,20 @@ struct GPUSceneData {
 
 struct GPUObjectData {
     glm::mat4 modelMatrix;
+    //index into the bindless texture array, padded to the std140 array stride
+    uint32_t textureIndex;
+    uint32_t padding[3];
 };
 
-struct DeletionQueue {
-    std::deque<std::function<void()>> deletors;
-
-    void push_function(std::function<void()> &&function) {
-        deletors.push_back(function);
-    }
-
-    void flush() {
-        // reverse iterate the deletion queue to execute all the functions
-        for (auto it = deletors.rbegin(); it != deletors.rend(); it++) {
-            (*it)(); //call the function
-        }
+//counters gathered while recording the last frame
+struct FrameStats {
+    uint32_t drawCalls{0};
+    uint64_t triangles{0};
+};
 
-        deletors.clear();
-    }
+struct GpuFrameTime {
+    int frameNumber;
+    double milliseconds;
 };
 
 class PipelineBuilder {
@@ -119,17 +150,57 @@ public:
     VkPipelineMultisampleStateCreateInfo mMultisampling;
     VkPipelineLayout mPipelineLayout;
     VkPipelineDepthStencilStateCreateInfo mDepthStencil;
+    std::vector<VkDynamicState> mDynamicStates;
 
     VkPipeline build_pipeline(VkDevice device, VkRenderPass pass);
 };
 
-//number of frames to overlap when rendering
-constexpr unsigned int FRAME_OVERLAP = 2;
+//upper bound for the number of frames to overlap when rendering, the real count is picked at startup
+constexpr unsigned int MAX_FRAMES_IN_FLIGHT = 4;
+
+//entries in each frame's object buffer, transforms with higher ids are not drawn
+constexpr uint32_t MAX_OBJECTS = 10000;
+
+//slots in the bindless texture table, clamped to the device limit at startup
+constexpr uint32_t MAX_BINDLESS_TEXTURES = 4096;
+
+//GLSL sources, watched by the shader hot reloader. Set by CMake
+constexpr const char *SHADER_SOURCE_DIRECTORY = VKSLIME_SHADER_SOURCE_DIR;
+
+//SPIR-V the build compiled from the sources, which is what the engine loads. Set by CMake
+constexpr const char *SHADER_DIRECTORY = VKSLIME_SHADER_BINARY_DIR;
+
+//shader reflection results kept between runs, in the build directory next to the SPIR-V they describe. Set by CMake
+constexpr const char *SHADER_REFLECTION_CACHE_PATH = VKSLIME_SHADER_REFLECTION_CACHE;
+
+//startup options for the engine
+struct EngineConfig {
+    //frames the CPU can record ahead of the GPU (1-4). Fewer frames means less latency, more means more throughput
+    uint32_t framesInFlight{2};
+
+    //FIFO is vsync, MAILBOX and IMMEDIATE let benchmarks run uncapped. Falls back to FIFO if unsupported
+    VkPresentModeKHR presentMode{VK_PRESENT_MODE_FIFO_KHR};
+
+    //size of the window, or of the offscreen targets when headless
+    VkExtent2D extent{1920, 1080};
+
+    //render into offscreen images without SDL or a swapchain, run headlessFrames frames and return from run()
+    bool headless{false};
+    uint32_t headlessFrames{100};
+    //if set, the last headless frame is written to this path as a PPM image
+    std::string headlessDumpPath;
+
+    TextureStreamingConfig textureStreaming;
+
+    //recompile and swap in shaders edited while the engine runs. Windowed only, uses the glslangValidator the
+    //build found
+    bool shaderHotReload{true};
+};
 
 class VulkanEngine {
 public:
-    //initializes everything in the engine
-    void init();
+    //initializes everything in the engine. Returns false when something the engine can't run without failed
+    bool init(const EngineConfig &config = EngineConfig{});
 
     //shuts down the engine
     void cleanup();
@@ -140,11 +211,21 @@ public:
     //run main loop
     void run();
 
+    //renders the scene along a scripted camera path and writes frame time statistics, works windowed and headless
+    void run_benchmark(const BenchmarkConfig &config);
+
+    //copies a rendered offscreen target into a PPM file, blocks until the copy is done. Headless only
+    bool dump_image(uint32_t imageIndex, const std::string &path);
+
+    //rebuilds the swapchain with the new present mode at the start of the next frame
+    void set_present_mode(VkPresentModeKHR presentMode);
+
     //getter for the frame we are rendering to right now.
     FrameData &get_current_frame();
 
     //Create material and it to the map
-    Material *create_material(VkPipeline pipeline, VkPipelineLayout layout, const std::string_view &name);
+    //the material draws with the variant of the effect that has exactly the given features, built on first use
+    Material *create_material(const std::string &effectName, ShaderFeatures features, const std::string_view &name);
 
     //Returns nullptr if it can't be found
     Material *get_material(const std::string &name);
@@ -158,6 +239,26 @@ public:
 
     void immediate_submit(std::function<void(VkCommandBuffer cmd)> &&function);
 
+    //returns the highest value the GPU has signalled on the engine timeline
+    uint64_t get_completed_timeline_value() const;
+
+    //blocks until the GPU has reached the given value on the engine timeline, timeout is in nanoseconds.
+    //returns false if the timeout ran out first
+    bool wait_for_timeline_value(uint64_t value, uint64_t timeout = 1000000000) const;
+
+    //reads back the GPU profiler results of a retired frame slot and records the frame's GPU time
+    void collect_gpu_timings(uint32_t frameIndex);
+
+    //deferred destruction helpers, safe to call at runtime without waiting for the device to go idle.
+    //the resource is released once every frame that could still be using it has retired
+    void destroy_buffer(const AllocatedBufferUntyped &buffer);
+
+    void destroy_image(const AllocatedImage &image);
+
+    void destroy_pipeline(VkPipeline pipeline);
+
+    void destroy_descriptor_pool(VkDescriptorPool pool);
+
     // This function is incomplete
     ImTextureID AddTexture(VkImageLayout imageLayout, VkImageView imageView, VkSampler sampler);
 
@@ -165,9 +266,15 @@ public:
     VkDebugUtilsMessengerEXT mDebugMessenger; // Vulkan debug output handle
     VkPhysicalDevice mChosenGPU; // GPU chosen as the default device
     VkDevice mDevice; // Vulkan device for commands
-    VkSurfaceKHR mSurface; // Vulkan window surface
+    VkSurfaceKHR mSurface{VK_NULL_HANDLE}; // Vulkan window surface
+
+    VkSwapchainKHR mSwapchain{VK_NULL_HANDLE}; // from other articles
+
+    VkPresentModeKHR mPresentMode{VK_PRESENT_MODE_FIFO_KHR}; // present mode the swapchain was built with
+    VkPresentModeKHR mRequestedPresentMode{VK_PRESENT_MODE_FIFO_KHR};
 
-    VkSwapchainKHR mSwapchain; // from other articles
+    //set when the window resized or the swapchain went out of date, the swapchain is rebuilt before the next frame
+    bool mSwapchainDirty{false};
 
     // image format expected by the windowing system
     VkFormat mSwapchainImageFormat;
@@ -178,6 +285,15 @@ public:
     //array of image-views from the swapchain
     std::vector<VkImageView> mSwapchainImageViews;
 
+    //headless mode renders into these instead, they are also listed in mSwapchainImages/mSwapchainImageViews
+    std::vector<AllocatedImage> mOffscreenImages;
+    //image the last draw rendered into
+    uint32_t mLastImageIndex{0};
+
+    bool mHeadless{false};
+    uint32_t mHeadlessFrameCount{0};
+    std::string mHeadlessDumpPath;
+
     VkQueue mGraphicsQueue; //queue we will submit to
     uint32_t mGraphicsQueueFamily; //family of that queue
 
@@ -185,8 +301,14 @@ public:
 
     std::vector<VkFramebuffer> mFramebuffers;
 
-    //frame storage
-    FrameData mFrames[FRAME_OVERLAP];
+    //frame storage, only the first mFramesInFlight are used
+    FrameData mFrames[MAX_FRAMES_IN_FLIGHT];
+    uint32_t mFramesInFlight{2};
+
+    //single timeline semaphore every queue submission signals, frames and uploads wait on values of it
+    VkSemaphore mTimelineSemaphore;
+    //last value handed out on the timeline
+    uint64_t mTimelineValue{0};
 
     VmaAllocator mAllocator; //vma lib allocator
 
@@ -199,6 +321,11 @@ public:
     //Array of renderable objects
     std::vector<RenderObject> mRenderables;
 
+    //local and world transforms of the renderables, each frame's object buffer is one of its consumers
+    TransformSystem mTransforms;
+    //objects past MAX_OBJECTS have no slot in the object buffer and aren't drawn, warned about the first time
+    bool mObjectOverflowReported{false};
+
     std::unordered_map<std::string_view, Material> mMaterials;
     std::unordered_map<std::string_view, Mesh> mMeshes;
     std::unordered_map<std::string_view, Texture> mLoadedTextures;
@@ -208,7 +335,18 @@ public:
 
     VkDescriptorSetLayout mGlobalSetLayout;
     VkDescriptorSetLayout mObjectSetLayout;
-    VkDescriptorPool mDescriptorPool;
+    //sets that live as long as the engine, per frame sets come from mDescriptorSetCache
+    vkutil::DescriptorAllocator mDescriptorAllocator;
+    //owns every set layout built through it, equal layouts share one handle
+    vkutil::DescriptorLayoutCache mDescriptorLayoutCache;
+    //sets keyed by layout and contents, reused across frames while their resources stay the same
+    vkutil::DescriptorSetCache mDescriptorSetCache;
+
+    //reflected shader effects and the pipeline layouts they share
+    ShaderEffectRegistry mShaderEffects;
+    //pipeline variants built so far, by effect name and features
+    std::map<std::pair<std::string, ShaderFeatures>, VkPipeline> mEffectPipelines;
+    ShaderHotReloader mShaderReloader;
 
     VkPhysicalDeviceProperties mGpuProperties;
 
@@ -219,6 +357,9 @@ public:
 
     VkDescriptorSetLayout mSingleTextureSetLayout;
 
+    //every texture materials sample, bound once as set 2
+    BindlessTextureTable mBindlessTextures;
+
     ImguiLayer layer;
 
     std::string mCurrentProjectPath;
@@ -226,11 +367,29 @@ public:
     //-----------------------------------
     DeletionQueue mMainDeletionQueue;
 
+    //deferred deletions requested since the last frame submit, they are handed to that frame when it is submitted
+    DeletionQueue mPendingDeletionQueue;
+
     struct SDL_Window *mWindow{nullptr};
     bool mIsInitialized{false};
     int mFrameNumber{0};
 
     VkExtent2D mWindowExtent{1920, 1080};
+
+    FrameStats mFrameStats;
+
+    //the benchmark drives the camera through this instead of the default animation
+    bool mUseCameraOverride{false};
+    glm::mat4 mCameraOverride{1.0f};
+
+    //timestamp regions per pass, shown in the GPU Profiler panel and as Tracy GPU zones
+    GpuProfiler mGpuProfiler;
+    //GPU time of each retired frame, only filled while mRecordGpuFrameTimes is set
+    bool mRecordGpuFrameTimes{false};
+    std::vector<GpuFrameTime> mGpuFrameTimes;
+
+    //keeps baked textures' mips in VRAM as the camera needs them
+    TextureStreamer mTextureStreamer;
     //-----------------------------------
 
 private:
@@ -238,6 +397,17 @@ private:
 
     void init_swapchain();
 
+    //headless replacement for init_swapchain
+    void init_offscreen_targets();
+
+    void init_depth_image();
+
+    //destroys framebuffers, swapchain image views and the depth image
+    void destroy_swapchain_resources();
+
+    //returns false if the window currently has no area to render into
+    bool recreate_swapchain();
+
     void init_commands();
 
     void init_default_renderpass();
@@ -248,14 +418,28 @@ private:
 
     void init_descriptors();
 
-    void init_pipeline();
+    //looks up the frame's global and object sets in the descriptor set cache
+    void build_frame_descriptors(FrameData &frame);
+
+    //false when the lit shaders or their pipeline couldn't be built
+    bool init_pipeline();
+
+    //the pipeline for this variant of the effect, building it the first time it is asked for
+    VkPipeline get_pipeline_variant(const std::string &effectName, ShaderFeatures features);
+
+    //the mesh pipeline state around an effect's shaders and layout, with the feature constants set.
+    //returns VK_NULL_HANDLE if creation fails
+    VkPipeline build_mesh_pipeline(ShaderEffect *effect, ShaderFeatures features);
+
+    //rebuilds the pipelines of effects whose SPIR-V changed on disk, called at the start of a frame
+    void reload_changed_shaders();
 
     void init_scene();
 
     void init_imgui();
 
-    //loads a shader module from a spir-v file. Returns false if it errors
-    VkShaderModule load_shader_module(const char *filePath);
+    //draws the configured number of frames without a window
+    void run_headless();
 
     void load_meshes();
 
@@ -264,4 +448,11 @@ private:
     bool load_image_to_cache(const char *name, const char *path);
 
     void upload_mesh(Mesh &mesh);
+
+    //moves materials whose streamed texture got a new image to a bindless slot holding it
+    void update_streamed_materials();
+
+    //bindless slots the streamer may hand to materials of replaced images, the ones still waiting for their
+    //first slot are served first
+    uint32_t get_streaming_free_slots() const;
 };
@@ -0,0 +1,73 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+namespace vkutil {
+
+    //streaming 64 bit hash over whole words, built from the xxHash64 round and avalanche.
+    //every word goes through the state in order, so permuted or repeated inputs don't collide the way
+    //an XOR of per-item hashes does. Lives on the stack and never allocates
+    class Hasher64 {
+    public:
+        explicit Hasher64(uint64_t seed = 0) : mState(seed + PRIME_5) {}
+
+        void add(uint64_t word) {
+            uint64_t lane = word * PRIME_2;
+            lane = rotl(lane, 31) * PRIME_1;
+            mState ^= lane;
+            mState = rotl(mState, 27) * PRIME_1 + PRIME_4;
+            mLength += 8;
+        }
+
+        uint64_t finish() const {
+            uint64_t hash = mState + mLength;
+            hash ^= hash >> 33;
+            hash *= PRIME_2;
+            hash ^= hash >> 29;
+            hash *= PRIME_3;
+            hash ^= hash >> 32;
+            return hash;
+        }
+
+    private:
+        static constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+        static constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+        static constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ull;
+        static constexpr uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ull;
+        static constexpr uint64_t PRIME_5 = 0x27D4EB2F165667C5ull;
+
+        static uint64_t rotl(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+        uint64_t mState;
+        uint64_t mLength{0};
+    };
+
+    //hash of a descriptor set layout, shared by the layout cache and shader reflection.
+    //bindings are hashed in the order given, callers sort them by binding number first. Covers everything
+    //that tells two layouts apart: flags, binding, type, count, stages and immutable samplers
+    inline uint64_t hash_descriptor_bindings(const VkDescriptorSetLayoutBinding *bindings, uint32_t count,
+                                             VkDescriptorSetLayoutCreateFlags flags) {
+        Hasher64 hasher;
+        hasher.add((uint64_t) flags << 32 | count);
+
+        for (uint32_t i = 0; i < count; i++) {
+            const VkDescriptorSetLayoutBinding &binding = bindings[i];
+            hasher.add((uint64_t) binding.descriptorType << 32 | binding.binding);
+            hasher.add((uint64_t) binding.stageFlags << 32 | binding.descriptorCount);
+
+            if (binding.pImmutableSamplers != nullptr) {
+                for (uint32_t s = 0; s < binding.descriptorCount; s++) {
+                    hasher.add((uint64_t) binding.pImmutableSamplers[s]);
+                }
+            }
+        }
+
+        return hasher.finish();
+    }
+}
@@ -339,6 +339,10 @@ VkSamplerCreateInfo vkslime::sampler_create_info(VkFilter filters,
     info.addressModeV = samplerAddressMode;
     info.addressModeW = samplerAddressMode;
 
+    //sample every mip the image has, single level images are unaffected
+    info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    info.maxLod = VK_LOD_CLAMP_NONE;
+
     LOGFUNCTION()
     return info;
 }
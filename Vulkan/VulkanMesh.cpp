@@ -9,6 +9,10 @@
 
 #include "tiny_obj_loader.h"
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include "Tracy.hpp"
 
 VertexInputDescription Vertex::get_vertex_description() {
     VertexInputDescription description;
@@ -57,6 +61,8 @@ VertexInputDescription Vertex::get_vertex_description() {
 }
 
 bool Mesh::load_from_obj(const char *filename) {
+    ZoneScopedNC("Load OBJ", tracy::Color::Magenta)
+
     //attrib will contain the vertex arrays of the file
     tinyobj::attrib_t attrib;
     //shapes contains the info for each separate object in the file
@@ -136,5 +142,29 @@ bool Mesh::load_from_obj(const char *filename) {
         }
     }
 
+    calculate_bounds();
+
     return true;
 }
+
+void Mesh::calculate_bounds() {
+    if (mVertices.empty()) {
+        return;
+    }
+
+    glm::vec3 min = mVertices[0].position;
+    glm::vec3 max = mVertices[0].position;
+    for (const Vertex &vertex: mVertices) {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+
+    mBoundsOrigin = (min + max) * 0.5f;
+
+    float radius2 = 0.0f;
+    for (const Vertex &vertex: mVertices) {
+        glm::vec3 offset = vertex.position - mBoundsOrigin;
+        radius2 = std::max(radius2, glm::dot(offset, offset));
+    }
+    mBoundsRadius = std::sqrt(radius2);
+}
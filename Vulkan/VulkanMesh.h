@@ -31,5 +31,11 @@ struct Mesh {
 
     AllocatedBufferUntyped mVertexBuffer;
 
+    //bounding sphere in model space, used to estimate how large the mesh is on screen
+    glm::vec3 mBoundsOrigin{0.0f};
+    float mBoundsRadius{0.0f};
+
+    void calculate_bounds();
+
     bool load_from_obj(const char *filename);
 };
@@ -0,0 +1,200 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "VulkanProfiler.h"
+#include "VulkanTools.h"
+#include "Log.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr uint32_t INVALID_REGION = UINT32_MAX;
+
+void GpuProfiler::init(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, uint32_t queueFamily,
+                       VkCommandBuffer setupCmd, const VkPhysicalDeviceProperties &properties,
+                       uint32_t framesInFlight, DeletionQueue &deletionQueue) {
+    mDevice = device;
+    mTimestampPeriod = properties.limits.timestampPeriod;
+
+    //timestampComputeAndGraphics only promises timestamps on every graphics queue, the family says what ours has
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+    uint32_t validBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0;
+
+    mSupported = validBits != 0;
+    if (!mSupported) {
+        Log::warn("GPU timestamps are not supported, GPU profiling is disabled");
+        return;
+    }
+    mTimestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+
+    VkQueryPoolCreateInfo queryPoolInfo = {};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.pNext = nullptr;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = MAX_GPU_PROFILER_REGIONS * 2;
+
+    mFrames.resize(framesInFlight);
+    for (FrameQueries &frame: mFrames) {
+        VK_CHECK_RESULT(vkCreateQueryPool(mDevice, &queryPoolInfo, nullptr, &frame.pool));
+        deletionQueue.push(DeletionType::QueryPool, frame.pool);
+    }
+
+    mQueryResults.resize(MAX_GPU_PROFILER_REGIONS * 2);
+    mTimings.reserve(MAX_GPU_PROFILER_REGIONS);
+
+    //tracy keeps its own query pool, it records and waits on a setup submit here
+    mTracyContext = TracyVkContext(physicalDevice, device, queue, setupCmd);
+}
+
+void GpuProfiler::cleanup() {
+    if (mTracyContext != nullptr) {
+        TracyVkDestroy(mTracyContext);
+        mTracyContext = nullptr;
+    }
+}
+
+void GpuProfiler::begin_frame(VkCommandBuffer cmd, uint32_t frameIndex, int frameNumber) {
+    if (!mSupported) {
+        return;
+    }
+
+    FrameQueries &frame = mFrames[frameIndex];
+    vkCmdResetQueryPool(cmd, frame.pool, 0, MAX_GPU_PROFILER_REGIONS * 2);
+
+    frame.frameNumber = frameNumber;
+    frame.regionCount = 0;
+    mRecording = &frame;
+    mDepth = 0;
+
+    //has to be recorded outside of a render pass
+    TracyVkCollect(mTracyContext, cmd);
+}
+
+uint32_t GpuProfiler::begin_region(VkCommandBuffer cmd, const char *name, VkPipelineStageFlagBits stage) {
+    if (mRecording == nullptr || mRecording->regionCount == MAX_GPU_PROFILER_REGIONS) {
+        return INVALID_REGION;
+    }
+
+    uint32_t region = mRecording->regionCount++;
+    mRecording->names[region] = name;
+    mRecording->depths[region] = mDepth++;
+
+    vkCmdWriteTimestamp(cmd, stage, mRecording->pool, region * 2);
+
+    return region;
+}
+
+void GpuProfiler::end_region(VkCommandBuffer cmd, uint32_t region, VkPipelineStageFlagBits stage) {
+    if (mRecording == nullptr || region == INVALID_REGION) {
+        return;
+    }
+
+    vkCmdWriteTimestamp(cmd, stage, mRecording->pool, region * 2 + 1);
+    mDepth--;
+}
+
+bool GpuProfiler::collect(uint32_t frameIndex) {
+    if (!mSupported) {
+        return false;
+    }
+
+    FrameQueries &frame = mFrames[frameIndex];
+    if (frame.frameNumber < 0 || frame.regionCount == 0) {
+        return false;
+    }
+
+    //no wait flag, if the results are not there yet the frame is simply skipped
+    VkResult result = vkGetQueryPoolResults(mDevice, frame.pool, 0, frame.regionCount * 2,
+                                            frame.regionCount * 2 * sizeof(uint64_t), mQueryResults.data(),
+                                            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+    const int frameNumber = frame.frameNumber;
+    frame.frameNumber = -1;
+
+    if (result != VK_SUCCESS) {
+        return false;
+    }
+
+    mTimings.clear();
+    for (uint32_t i = 0; i < frame.regionCount; i++) {
+        //masked after subtracting too, so a counter that wrapped inside the region still gives its length
+        uint64_t ticks = ((mQueryResults[i * 2 + 1] & mTimestampMask) - (mQueryResults[i * 2] & mTimestampMask)) &
+                         mTimestampMask;
+        double milliseconds = (double) ticks * mTimestampPeriod / 1e6;
+        mTimings.push_back({frame.names[i], frame.depths[i], milliseconds});
+
+        //blend into the smoothed value for the panel, new regions start at their first sample
+        auto it = std::find_if(mSmoothed.begin(), mSmoothed.end(), [&](const GpuRegionTiming &timing) {
+            return timing.name == frame.names[i];
+        });
+        if (it == mSmoothed.end()) {
+            mSmoothed.push_back(mTimings.back());
+        } else {
+            it->depth = frame.depths[i];
+            it->milliseconds = it->milliseconds * 0.95 + milliseconds * 0.05;
+        }
+    }
+    mTimingsFrame = frameNumber;
+
+    return true;
+}
+
+void GpuProfiler::draw_imgui() {
+    ImGui::Begin("GPU Profiler", nullptr);
+
+    if (!mSupported) {
+        ImGui::Text("Timestamps are not supported on this device");
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Text("Frame %d", mTimingsFrame);
+    ImGui::Separator();
+
+    if (ImGui::BeginTable("GpuRegions", 3)) {
+        ImGui::TableSetupColumn("Region");
+        ImGui::TableSetupColumn("ms");
+        ImGui::TableSetupColumn("avg ms");
+        ImGui::TableHeadersRow();
+
+        for (const GpuRegionTiming &timing: mTimings) {
+            auto it = std::find_if(mSmoothed.begin(), mSmoothed.end(), [&](const GpuRegionTiming &smoothed) {
+                return smoothed.name == timing.name;
+            });
+
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Indent((float) timing.depth * 10.0f + 1.0f);
+            ImGui::TextUnformatted(timing.name);
+            ImGui::Unindent((float) timing.depth * 10.0f + 1.0f);
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.3f", timing.milliseconds);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.3f", it != mSmoothed.end() ? it->milliseconds : timing.milliseconds);
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+GpuProfileScope::GpuProfileScope(GpuProfiler &profiler, VkCommandBuffer cmd, const char *name)
+        : mProfiler(profiler), mCmd(cmd)
+#ifdef TRACY_ENABLE
+        , mTracyZone(profiler.get_tracy_context(), __LINE__, __FILE__, strlen(__FILE__), __FUNCTION__,
+                     strlen(__FUNCTION__), name, strlen(name), cmd, profiler.get_tracy_context() != nullptr)
+#endif
+{
+    mRegion = mProfiler.begin_region(mCmd, name);
+}
+
+GpuProfileScope::~GpuProfileScope() {
+    mProfiler.end_region(mCmd, mRegion);
+}
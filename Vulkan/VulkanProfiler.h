@@ -0,0 +1,109 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include "VulkanTypes.h"
+#include "VulkanDeletionQueue.h"
+
+#include "TracyVulkan.hpp"
+
+#include <vector>
+
+//regions a single frame can time, each one uses two timestamp queries
+constexpr uint32_t MAX_GPU_PROFILER_REGIONS = 64;
+
+struct GpuRegionTiming {
+    const char *name;
+    //nesting level, 0 for regions opened outside any other region
+    uint32_t depth;
+    double milliseconds;
+};
+
+//per frame in flight timestamp queries around named regions of a command buffer.
+//results are read back once the frame's slot comes around again, so reading never stalls the CPU
+class GpuProfiler {
+public:
+    //does nothing if the graphics queue can not write timestamps
+    void init(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, uint32_t queueFamily,
+              VkCommandBuffer setupCmd, const VkPhysicalDeviceProperties &properties, uint32_t framesInFlight,
+              DeletionQueue &deletionQueue);
+
+    void cleanup();
+
+    //starts recording a frame's regions into its slot. The slot has to have been collected first
+    void begin_frame(VkCommandBuffer cmd, uint32_t frameIndex, int frameNumber);
+
+    //region names have to outlive the frame, string literals are expected
+    uint32_t begin_region(VkCommandBuffer cmd, const char *name,
+                          VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+    void end_region(VkCommandBuffer cmd, uint32_t region,
+                    VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+    //reads back the slot's results if the GPU has written them. Returns true when get_timings() changed
+    bool collect(uint32_t frameIndex);
+
+    //timings of the most recently collected frame, in the order the regions were opened
+    const std::vector<GpuRegionTiming> &get_timings() const { return mTimings; }
+
+    int get_timings_frame() const { return mTimingsFrame; }
+
+    bool is_supported() const { return mSupported; }
+
+    void draw_imgui();
+
+    TracyVkCtx get_tracy_context() const { return mTracyContext; }
+
+private:
+    struct FrameQueries {
+        VkQueryPool pool{VK_NULL_HANDLE};
+        //frame number recorded into this slot, -1 when there is nothing to read
+        int frameNumber{-1};
+        uint32_t regionCount{0};
+        const char *names[MAX_GPU_PROFILER_REGIONS];
+        uint32_t depths[MAX_GPU_PROFILER_REGIONS];
+    };
+
+    VkDevice mDevice{VK_NULL_HANDLE};
+    bool mSupported{false};
+    //nanoseconds per timestamp tick
+    float mTimestampPeriod{1.0f};
+    //bits of a timestamp the queue writes, the rest are undefined
+    uint64_t mTimestampMask{0};
+
+    std::vector<FrameQueries> mFrames;
+    FrameQueries *mRecording{nullptr};
+    uint32_t mDepth{0};
+
+    std::vector<uint64_t> mQueryResults;
+    std::vector<GpuRegionTiming> mTimings;
+    int mTimingsFrame{-1};
+
+    //exponentially smoothed region times for the panel, keyed by the name pointer
+    std::vector<GpuRegionTiming> mSmoothed;
+
+    TracyVkCtx mTracyContext{nullptr};
+};
+
+//opens a region on construction and closes it when it goes out of scope, also emits a Tracy GPU zone
+class GpuProfileScope {
+public:
+    GpuProfileScope(GpuProfiler &profiler, VkCommandBuffer cmd, const char *name);
+
+    ~GpuProfileScope();
+
+    GpuProfileScope(const GpuProfileScope &) = delete;
+
+    GpuProfileScope &operator=(const GpuProfileScope &) = delete;
+
+private:
+    GpuProfiler &mProfiler;
+    VkCommandBuffer mCmd;
+    uint32_t mRegion;
+
+#ifdef TRACY_ENABLE
+    tracy::VkCtxScope mTracyZone;
+#endif
+};
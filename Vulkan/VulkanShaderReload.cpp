@@ -0,0 +1,186 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "VulkanShaderReload.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+
+#ifdef __linux__
+
+#include <poll.h>
+#include <spawn.h>
+#include <sys/inotify.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+#endif
+
+static bool is_shader_source(const std::filesystem::path &path) {
+    static const char *extensions[] = {".vert", ".frag", ".comp", ".geom", ".tesc", ".tese"};
+    std::string extension = path.extension().string();
+    return std::any_of(std::begin(extensions), std::end(extensions),
+                       [&](const char *e) { return extension == e; });
+}
+
+bool ShaderHotReloader::init(const std::string &sourceDirectory, const std::string &outputDirectory,
+                             const std::string &compiler) {
+    mSourceDirectory = sourceDirectory;
+    mOutputDirectory = outputDirectory;
+    mCompiler = compiler;
+
+#ifdef __linux__
+    mInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (mInotify < 0) {
+        Log::warn("Shader hot reload disabled, inotify is not available");
+        return false;
+    }
+
+    //editors either write the file in place or write a temp file and move it over the original
+    mSourceWatch = inotify_add_watch(mInotify, mSourceDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    mOutputWatch = inotify_add_watch(mInotify, mOutputDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (mSourceWatch < 0 || mOutputWatch < 0) {
+        Log::warn("Shader hot reload disabled, can't watch " + mSourceDirectory + " and " + mOutputDirectory);
+        close(mInotify);
+        mInotify = -1;
+        return false;
+    }
+
+    mRunning = true;
+    mThread = std::thread(&ShaderHotReloader::watch_thread, this);
+
+    Log::info("Watching " + mSourceDirectory + " for shader changes");
+    return true;
+#else
+    Log::warn("Shader hot reload is only supported on Linux");
+    return false;
+#endif
+}
+
+void ShaderHotReloader::cleanup() {
+    mRunning = false;
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+
+#ifdef __linux__
+    if (mInotify >= 0) {
+        close(mInotify);
+        mInotify = -1;
+    }
+#endif
+
+    mChanged.clear();
+}
+
+std::vector<std::string> ShaderHotReloader::take_changed() {
+    std::lock_guard<std::mutex> lock(mChangedMutex);
+    std::vector<std::string> changed;
+    changed.swap(mChanged);
+    return changed;
+}
+
+void ShaderHotReloader::watch_thread() {
+#ifdef __linux__
+    //inotify events are variable length, the buffer has to be aligned for the header
+    alignas(inotify_event) char buffer[4096];
+
+    while (mRunning) {
+        //wake up regularly to notice cleanup
+        pollfd pfd{mInotify, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+
+        //one save tends to produce several events, gather them all before compiling anything
+        std::vector<std::string> sources;
+        std::vector<std::string> binaries;
+        ssize_t length;
+        while ((length = read(mInotify, buffer, sizeof(buffer))) > 0) {
+            for (char *ptr = buffer; ptr < buffer + length;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                if (event->len == 0) {
+                    continue;
+                }
+
+                //the engine only loads SPIR-V from the output directory, a .spv next to the sources is ignored
+                if (event->wd == mSourceWatch) {
+                    std::filesystem::path path = std::filesystem::path(mSourceDirectory) / event->name;
+                    if (is_shader_source(path)) {
+                        sources.push_back(path.string());
+                    }
+                } else if (event->wd == mOutputWatch) {
+                    std::filesystem::path path = std::filesystem::path(mOutputDirectory) / event->name;
+                    if (path.extension() == ".spv") {
+                        binaries.push_back(path.string());
+                    }
+                }
+            }
+        }
+
+        std::sort(sources.begin(), sources.end());
+        sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+        for (const std::string &source: sources) {
+            //the .spv this writes comes back as its own event and is queued then
+            compile(source);
+        }
+
+        if (!binaries.empty()) {
+            std::lock_guard<std::mutex> lock(mChangedMutex);
+            for (const std::string &binary: binaries) {
+                if (std::find(mChanged.begin(), mChanged.end(), binary) == mChanged.end()) {
+                    mChanged.push_back(binary);
+                }
+            }
+        }
+    }
+#endif
+}
+
+bool ShaderHotReloader::compile(const std::string &sourcePath) {
+    //same flags as the build's shader step
+    std::string outputPath =
+            (std::filesystem::path(mOutputDirectory) / std::filesystem::path(sourcePath).filename()).string() + ".spv";
+
+    Log::info("Recompiling " + sourcePath);
+#ifdef __linux__
+    //the file name comes from whatever was saved into the watched directory, so it is passed as its own argument
+    //and never goes through a shell
+    std::string arguments[] = {mCompiler, "-V", "--target-env", "vulkan1.2", sourcePath, "-o", outputPath};
+    char *argv[std::size(arguments) + 1] = {};
+    for (size_t i = 0; i < std::size(arguments); i++) {
+        argv[i] = arguments[i].data();
+    }
+
+    pid_t pid;
+    int error = posix_spawnp(&pid, mCompiler.c_str(), nullptr, nullptr, argv, environ);
+    if (error != 0) {
+        Log::error("Failed to run " + mCompiler + ": " + std::strerror(error));
+        return false;
+    }
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            Log::error("Failed to wait for " + mCompiler + ": " + std::strerror(errno));
+            return false;
+        }
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        Log::error("Failed to compile " + sourcePath + ", keeping the previous version");
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,47 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//watches the shader sources for edits while the engine runs. A saved GLSL source is recompiled to SPIR-V in the
+//output directory on a background thread, and every SPIR-V file written into the output directory, by that compile
+//or by an outside tool, is queued for the engine to pick up at the start of a frame. Uses inotify, so it only
+//watches on Linux
+class ShaderHotReloader {
+public:
+    //compiler is the glslangValidator executable, looked up on PATH unless it is a path.
+    //returns false if watching is not possible
+    bool init(const std::string &sourceDirectory, const std::string &outputDirectory, const std::string &compiler);
+
+    //stops the watch thread, waiting for a compile that is running to finish
+    void cleanup();
+
+    //SPIR-V files written since the last call, each listed once
+    std::vector<std::string> take_changed();
+
+private:
+    void watch_thread();
+
+    //runs the compiler on one source file, the output lands in the output directory as <source name>.spv
+    bool compile(const std::string &sourcePath);
+
+    std::string mSourceDirectory;
+    std::string mOutputDirectory;
+    std::string mCompiler;
+
+    int mInotify{-1};
+    int mSourceWatch{-1};
+    int mOutputWatch{-1};
+    std::thread mThread;
+    std::atomic<bool> mRunning{false};
+
+    std::mutex mChangedMutex;
+    std::vector<std::string> mChanged;
+};
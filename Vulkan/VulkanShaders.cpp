@@ -5,14 +5,18 @@
 #include "VulkanShaders.h"
 
 #include "VulkanInitializers.h"
+#include "VulkanHash.h"
+#include "Log.h"
 #include <fstream>
 #include <vector>
 #include <algorithm>
 
 #include "spirv_reflect.h"
 #include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
 
-#include <sstream>
 #include <iostream>
 
 bool vkslime::load_shader_module(VkDevice device, const char *filePath, ShaderModule *outShaderModule) {
@@ -40,6 +44,11 @@ bool vkslime::load_shader_module(VkDevice device, const char *filePath, ShaderMo
     //now that the file is loaded into the buffer, we can close it
     file.close();
 
+    //a file that isn't SPIR-V, or one still being written during a hot reload, never reaches the driver
+    if (buffer.empty() || buffer[0] != 0x07230203) {
+        return false;
+    }
+
     //create a new shader module, using the buffer we loaded
     VkShaderModuleCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -60,30 +69,9 @@ bool vkslime::load_shader_module(VkDevice device, const char *filePath, ShaderMo
     return true;
 }
 
-// FNV-1a 32bit hashing algorithm.
-constexpr uint32_t fnv1a_32(char const *s, std::size_t count) {
-    return ((count ? fnv1a_32(s, count - 1) : 2166136261u) ^ s[count]) * 16777619u;
-}
-
-uint32_t vkslime::hash_descriptor_layout_info(VkDescriptorSetLayoutCreateInfo *info) {
-    //we are going to put all the data into a string and then hash the string
-    std::stringstream ss;
-
-    ss << info->flags;
-    ss << info->bindingCount;
-
-    for (auto i = 0u; i < info->bindingCount; i++) {
-        const VkDescriptorSetLayoutBinding &binding = info->pBindings[i];
-
-        ss << binding.binding;
-        ss << binding.descriptorCount;
-        ss << binding.descriptorType;
-        ss << binding.stageFlags;
-    }
-
-    auto str = ss.str();
-
-    return fnv1a_32(str.c_str(), str.length());
+uint64_t vkslime::hash_descriptor_layout_info(VkDescriptorSetLayoutCreateInfo *info) {
+    //same hash the layout cache uses, so both agree on which layouts are equal
+    return vkutil::hash_descriptor_bindings(info->pBindings, info->bindingCount, info->flags);
 }
 
 void ShaderEffect::add_stage(ShaderModule *shaderModule, VkShaderStageFlagBits stage) {
@@ -97,10 +85,20 @@ struct DescriptorSetLayoutData {
     std::vector<VkDescriptorSetLayoutBinding> bindings;
 };
 
-void ShaderEffect::reflect_layout(VkDevice device, ReflectionOverrides *overrides, int overrideCount) {
+void ShaderEffect::reflect_layout(vkutil::DescriptorLayoutCache &layoutCache,
+                                  const std::array<VkDescriptorSetLayout, 4> &fixedLayouts,
+                                  const ReflectionOverrides *overrides, int overrideCount) {
+    ShaderReflection reflection;
+    reflect(reflection, overrides, overrideCount);
+    build_layouts(reflection, layoutCache, fixedLayouts);
+}
+
+void ShaderEffect::reflect(ShaderReflection &outReflection, const ReflectionOverrides *overrides,
+                           int overrideCount) const {
     std::vector<DescriptorSetLayoutData> set_layouts;
 
-    std::vector<VkPushConstantRange> constant_ranges;
+    outReflection = {};
+    std::vector<VkPushConstantRange> &pushConstantRanges = outReflection.pushConstantRanges;
 
     for (auto &s: stages) {
 
@@ -141,17 +139,14 @@ void ShaderEffect::reflect_layout(VkDevice device, ReflectionOverrides *override
                 }
                 layout_binding.stageFlags = static_cast<VkShaderStageFlagBits>(spvmodule.shader_stage);
 
-                ReflectedBinding reflected{};
+                ShaderReflection::Binding reflected{};
                 reflected.binding = layout_binding.binding;
                 reflected.set = refl_set.set;
                 reflected.type = layout_binding.descriptorType;
 
-                bindings[refl_binding.name] = reflected;
+                outReflection.bindings[refl_binding.name] = reflected;
             }
             layout.setNumber = refl_set.set;
-            layout.createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-            layout.createInfo.bindingCount = refl_set.binding_count;
-            layout.createInfo.pBindings = layout.bindings.data();
 
             set_layouts.push_back(layout);
         }
@@ -171,16 +166,28 @@ void ShaderEffect::reflect_layout(VkDevice device, ReflectionOverrides *override
             pcs.size = pconstants[0]->size;
             pcs.stageFlags = s.stage;
 
-            constant_ranges.push_back(pcs);
+            //stages sharing one block share one range, so equal effects end up with equal signatures
+            auto same = std::find_if(pushConstantRanges.begin(), pushConstantRanges.end(),
+                                     [&](const VkPushConstantRange &range) {
+                                         return range.offset == pcs.offset && range.size == pcs.size;
+                                     });
+            if (same != pushConstantRanges.end()) {
+                same->stageFlags |= pcs.stageFlags;
+            } else {
+                pushConstantRanges.push_back(pcs);
+            }
         }
-    }
 
+        spvReflectDestroyShaderModule(&spvmodule);
+    }
 
-    std::array<DescriptorSetLayoutData, 4> merged_layouts;
+    for (auto &s: set_layouts) {
+        outReflection.setCount = std::max(outReflection.setCount, s.setNumber + 1);
+    }
 
-    for (int i = 0; i < 4; i++) {
+    for (uint32_t i = 0; i < 4; i++) {
 
-        DescriptorSetLayoutData &ly = merged_layouts[i];
+        DescriptorSetLayoutData ly{};
 
         ly.setNumber = i;
 
@@ -193,7 +200,6 @@ void ShaderEffect::reflect_layout(VkDevice device, ReflectionOverrides *override
                     auto it = binds.find(b.binding);
                     if (it == binds.end()) {
                         binds[b.binding] = b;
-                        //ly.bindings.push_back(b);
                     } else {
                         //merge flags
                         binds[b.binding].stageFlags |= b.stageFlags;
@@ -217,44 +223,117 @@ void ShaderEffect::reflect_layout(VkDevice device, ReflectionOverrides *override
         ly.createInfo.flags = 0;
         ly.createInfo.pNext = nullptr;
 
-
         if (ly.createInfo.bindingCount > 0) {
-            setHashes[i] = vkslime::hash_descriptor_layout_info(&ly.createInfo);
-            vkCreateDescriptorSetLayout(device, &ly.createInfo, nullptr, &setLayouts[i]);
-        } else {
+            outReflection.setHashes[i] = vkslime::hash_descriptor_layout_info(&ly.createInfo);
+        }
+        outReflection.setBindings[i] = std::move(ly.bindings);
+    }
+}
+
+void ShaderEffect::build_layouts(const ShaderReflection &reflection, vkutil::DescriptorLayoutCache &layoutCache,
+                                 const std::array<VkDescriptorSetLayout, 4> &fixedLayouts) {
+    bindings = reflection.bindings;
+    setCount = reflection.setCount;
+    pushConstantRanges = reflection.pushConstantRanges;
+
+    for (uint32_t i = 0; i < 4; i++) {
+        if (i >= setCount) {
             setHashes[i] = 0;
             setLayouts[i] = VK_NULL_HANDLE;
+        } else if (fixedLayouts[i] != VK_NULL_HANDLE) {
+            //the engine's own layout, equal handles mean equal layouts
+            vkutil::Hasher64 hasher;
+            hasher.add((uint64_t) fixedLayouts[i]);
+            setHashes[i] = hasher.finish();
+            setLayouts[i] = fixedLayouts[i];
+        } else {
+            //an unused set in between gets an empty layout, it keeps the set numbers of the ones after it
+            VkDescriptorSetLayoutCreateInfo createInfo{};
+            createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            createInfo.bindingCount = (uint32_t) reflection.setBindings[i].size();
+            createInfo.pBindings = reflection.setBindings[i].data();
+
+            setHashes[i] = reflection.setHashes[i];
+            setLayouts[i] = layoutCache.create_descriptor_layout(&createInfo);
         }
     }
+}
 
-    //we start from just the default empty pipeline layout info
-    VkPipelineLayoutCreateInfo mesh_pipeline_layout_info = vkslime::pipeline_layout_create_info();
-
-    mesh_pipeline_layout_info.pPushConstantRanges = constant_ranges.data();
-    mesh_pipeline_layout_info.pushConstantRangeCount = (uint32_t) constant_ranges.size();
 
-    std::array<VkDescriptorSetLayout, 4> compactedLayouts{};
-    int s = 0;
-    for (int i = 0; i < 4; i++) {
-        if (setLayouts[i] != VK_NULL_HANDLE) {
-            compactedLayouts[s] = setLayouts[i];
-            s++;
-        }
+void ShaderEffect::fill_stages(std::vector<VkPipelineShaderStageCreateInfo> &pipelineStages,
+                               const VkSpecializationInfo *specialization) {
+    for (auto &s: stages) {
+        VkPipelineShaderStageCreateInfo stageInfo = vkslime::pipeline_shader_stage_create_info(
+                s.stage, s.shaderModule->module);
+        stageInfo.pSpecializationInfo = specialization;
+        pipelineStages.push_back(stageInfo);
     }
+}
 
-    mesh_pipeline_layout_info.setLayoutCount = s;
-    mesh_pipeline_layout_info.pSetLayouts = compactedLayouts.data();
+ShaderVariantConstants::ShaderVariantConstants(ShaderFeatures features) {
+    for (uint32_t i = 0; i < SHADER_FEATURE_COUNT; i++) {
+        entries[i].constantID = i;
+        entries[i].offset = i * (uint32_t) sizeof(VkBool32);
+        entries[i].size = sizeof(VkBool32);
+        values[i] = (features & (1u << i)) != 0 ? VK_TRUE : VK_FALSE;
+    }
 
+    info.mapEntryCount = SHADER_FEATURE_COUNT;
+    info.pMapEntries = entries.data();
+    info.dataSize = sizeof(values);
+    info.pData = values.data();
+}
 
-    vkCreatePipelineLayout(device, &mesh_pipeline_layout_info, nullptr, &builtLayout);
+uint64_t ShaderEffect::reflection_key(const ReflectionOverrides *overrides, int overrideCount) const {
+    //covers everything reflect reads: the code and stage of each module, and the overrides
+    vkutil::Hasher64 hasher;
+    for (const ShaderStage &s: stages) {
+        hasher.add((uint64_t) s.stage << 32 | (uint32_t) s.shaderModule->code.size());
+        for (uint32_t word: s.shaderModule->code) {
+            hasher.add(word);
+        }
+    }
+    for (int ov = 0; ov < overrideCount; ov++) {
+        std::string_view name = overrides[ov].name;
+        hasher.add(name.size());
+        for (char c: name) {
+            hasher.add((uint8_t) c);
+        }
+        hasher.add(overrides[ov].overridenType);
+    }
+    return hasher.finish();
+}
 
+bool ShaderEffect::uses_module(const ShaderModule *shaderModule) const {
+    return std::any_of(stages.begin(), stages.end(),
+                       [&](const ShaderStage &s) { return s.shaderModule == shaderModule; });
 }
 
+ShaderFeatures ShaderEffect::declared_features() const {
+    constexpr uint32_t SPV_HEADER_WORDS = 5;
+    constexpr uint32_t SPV_OP_DECORATE = 71;
+    constexpr uint32_t SPV_DECORATION_SPEC_ID = 1;
+
+    ShaderFeatures declared = 0;
+    for (const ShaderStage &s: stages) {
+        const std::vector<uint32_t> &code = s.shaderModule->code;
+        //each instruction starts with its word count in the high half and its opcode in the low half
+        for (size_t i = SPV_HEADER_WORDS; i < code.size();) {
+            uint32_t wordCount = code[i] >> 16;
+            uint32_t opcode = code[i] & 0xFFFF;
+            if (wordCount == 0 || i + wordCount > code.size()) {
+                break;
+            }
 
-void ShaderEffect::fill_stages(std::vector<VkPipelineShaderStageCreateInfo> &pipelineStages) {
-    for (auto &s: stages) {
-        pipelineStages.push_back(vkslime::pipeline_shader_stage_create_info(s.stage, s.shaderModule->module));
+            //OpDecorate %target SpecId constant_id
+            if (opcode == SPV_OP_DECORATE && wordCount == 4 && code[i + 2] == SPV_DECORATION_SPEC_ID &&
+                code[i + 3] < SHADER_FEATURE_COUNT) {
+                declared |= 1u << code[i + 3];
+            }
+            i += wordCount;
+        }
     }
+    return declared;
 }
 
 void ShaderDescriptorBinder::bind_buffer(const char *name, const VkDescriptorBufferInfo &bufferInfo) {
@@ -299,11 +378,12 @@ void ShaderDescriptorBinder::bind_dynamic_buffer(const char *name, uint32_t offs
         cachedDescriptorSets[bind.set] = VK_NULL_HANDLE;
 
         bufferWrites.push_back(newWrite);
+        writesDirty = true;
     }
 }
 
 void ShaderDescriptorBinder::apply_binds(VkCommandBuffer cmd) {
-    for (int i = 0; i < 2; i++) {
+    for (uint32_t i = 0; i < shaders->setCount; i++) {
         //there are writes for this set
         if (cachedDescriptorSets[i] != VK_NULL_HANDLE) {
 
@@ -313,58 +393,55 @@ void ShaderDescriptorBinder::apply_binds(VkCommandBuffer cmd) {
     }
 }
 
-void ShaderDescriptorBinder::build_sets(VkDevice device, vkutil::DescriptorAllocator &allocator) {
-    std::array<std::vector<VkWriteDescriptorSet>, 4> writes{};
-
-    std::sort(bufferWrites.begin(), bufferWrites.end(), [](BufferWriteDescriptor &a, BufferWriteDescriptor &b) {
-        if (b.dstSet == a.dstSet) {
-            return a.dstSet < b.dstSet;
-        } else {
-            return a.dstBinding < b.dstBinding;
-        }
-    });
+void ShaderDescriptorBinder::build_sets(vkutil::DescriptorSetCache &setCache) {
+    //writes only get added, so they only need sorting again after that
+    if (writesDirty) {
+        std::sort(bufferWrites.begin(), bufferWrites.end(),
+                  [](const BufferWriteDescriptor &a, const BufferWriteDescriptor &b) {
+                      if (a.dstSet != b.dstSet) {
+                          return a.dstSet < b.dstSet;
+                      }
+                      return a.dstBinding < b.dstBinding;
+                  });
+        writesDirty = false;
+    }
 
     //reset the dynamic offsets
     for (auto &s: setOffsets) {
         s.count = 0;
     }
 
-    for (BufferWriteDescriptor &w: bufferWrites) {
-        uint32_t set = w.dstSet;
-        VkWriteDescriptorSet write = vkslime::write_descriptor_buffer(w.descriptorType, VK_NULL_HANDLE, &w.bufferInfo,
-                                                                      w.dstBinding);
-
-        writes[set].push_back(write);
-
-        //dynamic offsets
-        if (w.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
-            w.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) {
-            DynOffsets &offsetSet = setOffsets[set];
-            offsetSet.offsets[offsetSet.count] = w.dynamic_offset;
-            offsetSet.count++;
+    //no set has more writes than there are in total, so this never needs to grow inside the loop
+    writeScratch.resize(bufferWrites.size());
+    size_t first = 0;
+    while (first < bufferWrites.size()) {
+        int set = bufferWrites[first].dstSet;
+
+        uint32_t writeCount = 0;
+        size_t last = first;
+        for (; last < bufferWrites.size() && bufferWrites[last].dstSet == set; last++) {
+            BufferWriteDescriptor &w = bufferWrites[last];
+            writeScratch[writeCount++] = vkslime::write_descriptor_buffer(w.descriptorType, VK_NULL_HANDLE,
+                                                                          &w.bufferInfo, w.dstBinding);
+
+            //dynamic offsets
+            if (w.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+                w.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) {
+                DynOffsets &offsetSet = setOffsets[set];
+                assert(offsetSet.count < offsetSet.offsets.size());
+                offsetSet.offsets[offsetSet.count] = w.dynamic_offset;
+                offsetSet.count++;
+            }
         }
-    }
 
-
-    for (int i = 0; i < 4; i++) {
-        //there are writes for this set
-        if (!writes[i].empty()) {
-
-            if (cachedDescriptorSets[i] == VK_NULL_HANDLE) {
-                //alloc
-                auto layout = shaders->setLayouts[i];
-
-                VkDescriptorSet newDescriptor;
-                allocator.allocate(&newDescriptor, layout);
-
-                for (auto &w: writes[i]) {
-                    w.dstSet = newDescriptor;
-                }
-                vkUpdateDescriptorSets(device, (uint32_t) writes[i].size(), writes[i].data(), 0, nullptr);
-
-                cachedDescriptorSets[i] = newDescriptor;
-            }
+        //asked every time even if nothing changed, that is what keeps the set from being evicted
+        if (!setCache.get(shaders->setLayouts[set], writeScratch.data(), writeCount, cachedDescriptorSets[set])) {
+            //binding a stale or null set would fault on the GPU, apply_binds skips it instead
+            Log::error("Failed to get descriptor set " + std::to_string(set) + " from the descriptor set cache");
+            cachedDescriptorSets[set] = VK_NULL_HANDLE;
         }
+
+        first = last;
     }
 }
 
@@ -404,4 +481,401 @@ ShaderModule *ShaderCache::get_shader(const std::string &path) {
         module_cache[path] = newShader;
     }
     return &module_cache[path];
-}
\ No newline at end of file
+}
+
+ShaderModule *ShaderCache::reload_shader(const std::string &path) {
+    std::filesystem::path changedPath = std::filesystem::path(path).lexically_normal();
+
+    for (auto &[cachedPath, shader]: module_cache) {
+        if (std::filesystem::path(cachedPath).lexically_normal() != changedPath) {
+            continue;
+        }
+
+        ShaderModule newShader;
+        if (!vkslime::load_shader_module(_device, cachedPath.c_str(), &newShader)) {
+            Log::error("Failed to reload shader " + cachedPath + ", keeping the previous version");
+            return nullptr;
+        }
+
+        //pipelines don't reference their modules once created, so the old one can go straight away
+        vkDestroyShaderModule(_device, shader.module, nullptr);
+        shader = std::move(newShader);
+        return &shader;
+    }
+    return nullptr;
+}
+
+void ShaderCache::cleanup() {
+    for (auto &[path, shader]: module_cache) {
+        vkDestroyShaderModule(_device, shader.module, nullptr);
+    }
+    module_cache.clear();
+}
+
+//cache file layout: header, then per entry the key, set count, set hashes, the bindings of each set, the push
+//constant ranges and the named bindings. Everything is little endian words written as they are in memory
+static constexpr char REFLECTION_CACHE_MAGIC[4] = {'S', 'R', 'F', 'L'};
+static constexpr uint32_t REFLECTION_CACHE_VERSION = 1;
+
+namespace {
+    struct CacheWriter {
+        std::vector<char> data;
+
+        void u32(uint32_t value) { data.insert(data.end(), (const char *) &value, (const char *) &value + 4); }
+
+        void u64(uint64_t value) { data.insert(data.end(), (const char *) &value, (const char *) &value + 8); }
+
+        void str(const std::string &value) {
+            u32((uint32_t) value.size());
+            data.insert(data.end(), value.begin(), value.end());
+        }
+    };
+
+    //every read is bounds checked, a truncated file sets failed instead of reading past the end
+    struct CacheReader {
+        const std::vector<char> &data;
+        size_t offset{0};
+        bool failed{false};
+
+        bool read(void *destination, size_t size) {
+            if (failed || data.size() - offset < size) {
+                failed = true;
+                return false;
+            }
+            memcpy(destination, data.data() + offset, size);
+            offset += size;
+            return true;
+        }
+
+        uint32_t u32() {
+            uint32_t value = 0;
+            read(&value, 4);
+            return value;
+        }
+
+        uint64_t u64() {
+            uint64_t value = 0;
+            read(&value, 8);
+            return value;
+        }
+
+        std::string str() {
+            uint32_t size = u32();
+            if (failed || data.size() - offset < size) {
+                failed = true;
+                return {};
+            }
+            std::string value(data.data() + offset, size);
+            offset += size;
+            return value;
+        }
+
+        //counts come from the file, so check they could fit before reserving for them
+        uint32_t count(size_t minimumItemSize) {
+            uint32_t value = u32();
+            if (!failed && (data.size() - offset) / minimumItemSize < value) {
+                failed = true;
+                return 0;
+            }
+            return value;
+        }
+    };
+}
+
+bool ShaderReflectionCache::load(const std::string &path) {
+    mEntries.clear();
+    mUsed.clear();
+    mDirty = false;
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::vector<char> data((size_t) file.tellg());
+    file.seekg(0);
+    file.read(data.data(), (std::streamsize) data.size());
+    file.close();
+
+    CacheReader reader{data};
+
+    char magic[4] = {};
+    reader.read(magic, 4);
+    uint32_t version = reader.u32();
+    if (reader.failed || memcmp(magic, REFLECTION_CACHE_MAGIC, 4) != 0 || version != REFLECTION_CACHE_VERSION) {
+        Log::warn("Ignoring shader reflection cache " + path + ", it is from another version");
+        return false;
+    }
+
+    uint32_t entryCount = reader.count(8);
+    for (uint32_t e = 0; e < entryCount && !reader.failed; e++) {
+        uint64_t key = reader.u64();
+        ShaderReflection &reflection = mEntries[key];
+
+        reflection.setCount = std::min(reader.u32(), 4u);
+        for (uint64_t &hash: reflection.setHashes) {
+            hash = reader.u64();
+        }
+
+        for (auto &setBindings: reflection.setBindings) {
+            setBindings.resize(reader.count(16));
+            for (VkDescriptorSetLayoutBinding &binding: setBindings) {
+                binding = {};
+                binding.binding = reader.u32();
+                binding.descriptorType = (VkDescriptorType) reader.u32();
+                binding.descriptorCount = reader.u32();
+                binding.stageFlags = reader.u32();
+            }
+        }
+
+        reflection.pushConstantRanges.resize(reader.count(12));
+        for (VkPushConstantRange &range: reflection.pushConstantRanges) {
+            range.stageFlags = reader.u32();
+            range.offset = reader.u32();
+            range.size = reader.u32();
+        }
+
+        uint32_t bindingCount = reader.count(16);
+        for (uint32_t b = 0; b < bindingCount && !reader.failed; b++) {
+            std::string name = reader.str();
+            ShaderReflection::Binding binding{};
+            binding.set = reader.u32();
+            binding.binding = reader.u32();
+            binding.type = (VkDescriptorType) reader.u32();
+            reflection.bindings[name] = binding;
+        }
+    }
+
+    if (reader.failed) {
+        Log::warn("Ignoring shader reflection cache " + path + ", the file is damaged");
+        mEntries.clear();
+        return false;
+    }
+
+    Log::info("Loaded " + std::to_string(mEntries.size()) + " shader reflections from " + path);
+    return true;
+}
+
+bool ShaderReflectionCache::save(const std::string &path) {
+    //every used entry is either loaded or inserted, so equal counts mean nothing was left unused
+    if (!mDirty && mUsed.size() == mEntries.size()) {
+        return true;
+    }
+
+    std::erase_if(mEntries, [&](const auto &entry) { return !mUsed.contains(entry.first); });
+
+    CacheWriter writer;
+    writer.data.insert(writer.data.end(), REFLECTION_CACHE_MAGIC, REFLECTION_CACHE_MAGIC + 4);
+    writer.u32(REFLECTION_CACHE_VERSION);
+
+    writer.u32((uint32_t) mEntries.size());
+    for (const auto &[key, reflection]: mEntries) {
+        writer.u64(key);
+
+        writer.u32(reflection.setCount);
+        for (uint64_t hash: reflection.setHashes) {
+            writer.u64(hash);
+        }
+
+        for (const auto &setBindings: reflection.setBindings) {
+            writer.u32((uint32_t) setBindings.size());
+            for (const VkDescriptorSetLayoutBinding &binding: setBindings) {
+                writer.u32(binding.binding);
+                writer.u32(binding.descriptorType);
+                writer.u32(binding.descriptorCount);
+                writer.u32(binding.stageFlags);
+            }
+        }
+
+        writer.u32((uint32_t) reflection.pushConstantRanges.size());
+        for (const VkPushConstantRange &range: reflection.pushConstantRanges) {
+            writer.u32(range.stageFlags);
+            writer.u32(range.offset);
+            writer.u32(range.size);
+        }
+
+        writer.u32((uint32_t) reflection.bindings.size());
+        for (const auto &[name, binding]: reflection.bindings) {
+            writer.str(name);
+            writer.u32(binding.set);
+            writer.u32(binding.binding);
+            writer.u32(binding.type);
+        }
+    }
+
+    //write next to the old file and swap it in, so a crash mid write never leaves a damaged cache behind
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            Log::error("Failed to open " + tempPath + " for writing");
+            return false;
+        }
+        file.write(writer.data.data(), (std::streamsize) writer.data.size());
+        if (!file) {
+            Log::error("Failed to write " + tempPath);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        Log::error("Failed to replace " + path + ": " + error.message());
+        return false;
+    }
+
+    mDirty = false;
+    return true;
+}
+
+const ShaderReflection *ShaderReflectionCache::find(uint64_t key) {
+    auto it = mEntries.find(key);
+    if (it == mEntries.end()) {
+        return nullptr;
+    }
+    mUsed.insert(key);
+    return &it->second;
+}
+
+void ShaderReflectionCache::insert(uint64_t key, const ShaderReflection &reflection) {
+    mEntries[key] = reflection;
+    mUsed.insert(key);
+    mDirty = true;
+}
+
+void ShaderEffectRegistry::init(VkDevice device, vkutil::DescriptorLayoutCache *layoutCache) {
+    mDevice = device;
+    mLayoutCache = layoutCache;
+    mShaderCache.init(device);
+}
+
+void ShaderEffectRegistry::cleanup() {
+    for (auto &[key, layout]: mPipelineLayouts) {
+        vkDestroyPipelineLayout(mDevice, layout, nullptr);
+    }
+    mPipelineLayouts.clear();
+    mEffects.clear();
+    mShaderCache.cleanup();
+}
+
+void ShaderEffectRegistry::set_fixed_layout(uint32_t set, VkDescriptorSetLayout layout) {
+    mFixedLayouts[set] = layout;
+}
+
+ShaderEffect *ShaderEffectRegistry::get_effect(const std::string &name, const std::vector<StageInfo> &stages,
+                                               const std::vector<ShaderEffect::ReflectionOverrides> &overrides) {
+    auto it = mEffects.find(name);
+    if (it != mEffects.end()) {
+        return it->second.effect.get();
+    }
+
+    auto effect = std::make_unique<ShaderEffect>();
+    for (const StageInfo &stage: stages) {
+        ShaderModule *module = mShaderCache.get_shader(stage.path);
+        if (module == nullptr) {
+            return nullptr;
+        }
+        effect->add_stage(module, stage.stage);
+    }
+
+    build_effect(*effect, overrides);
+
+    ShaderEffect *result = effect.get();
+    mEffects[name] = {std::move(effect), overrides};
+    return result;
+}
+
+ShaderEffect *ShaderEffectRegistry::find_effect(const std::string &name) {
+    auto it = mEffects.find(name);
+    return it != mEffects.end() ? it->second.effect.get() : nullptr;
+}
+
+std::vector<std::string> ShaderEffectRegistry::reload_shaders(const std::vector<std::string> &paths) {
+    std::vector<const ShaderModule *> reloaded;
+    for (const std::string &path: paths) {
+        if (const ShaderModule *module = mShaderCache.reload_shader(path)) {
+            reloaded.push_back(module);
+        }
+    }
+
+    std::vector<std::string> rebuilt;
+    for (auto &[name, entry]: mEffects) {
+        bool affected = std::any_of(reloaded.begin(), reloaded.end(), [&](const ShaderModule *module) {
+            return entry.effect->uses_module(module);
+        });
+        if (affected) {
+            build_effect(*entry.effect, entry.overrides);
+            rebuilt.push_back(name);
+        }
+    }
+    return rebuilt;
+}
+
+void ShaderEffectRegistry::build_effect(ShaderEffect &effect,
+                                        const std::vector<ShaderEffect::ReflectionOverrides> &overrides) {
+    uint64_t reflectionKey = effect.reflection_key(overrides.data(), (int) overrides.size());
+
+    const ShaderReflection *reflection = mReflectionCache.find(reflectionKey);
+    if (reflection == nullptr) {
+        ShaderReflection newReflection;
+        effect.reflect(newReflection, overrides.data(), (int) overrides.size());
+        mReflectionCache.insert(reflectionKey, newReflection);
+        reflection = mReflectionCache.find(reflectionKey);
+    }
+
+    effect.build_layouts(*reflection, *mLayoutCache, mFixedLayouts);
+    effect.builtLayout = get_pipeline_layout(effect);
+}
+
+VkPipelineLayout ShaderEffectRegistry::get_pipeline_layout(const ShaderEffect &effect) {
+    PipelineLayoutKey key;
+    key.setLayouts = effect.setLayouts;
+    key.setCount = effect.setCount;
+    key.pushConstantRanges = effect.pushConstantRanges;
+
+    auto it = mPipelineLayouts.find(key);
+    if (it != mPipelineLayouts.end()) {
+        return it->second;
+    }
+
+    VkPipelineLayoutCreateInfo layoutInfo = vkslime::pipeline_layout_create_info();
+    layoutInfo.setLayoutCount = key.setCount;
+    layoutInfo.pSetLayouts = key.setLayouts.data();
+    layoutInfo.pushConstantRangeCount = (uint32_t) key.pushConstantRanges.size();
+    layoutInfo.pPushConstantRanges = key.pushConstantRanges.data();
+
+    VkPipelineLayout layout;
+    vkCreatePipelineLayout(mDevice, &layoutInfo, nullptr, &layout);
+
+    mPipelineLayouts.emplace(std::move(key), layout);
+    return layout;
+}
+
+bool ShaderEffectRegistry::PipelineLayoutKey::operator==(const PipelineLayoutKey &other) const {
+    if (setCount != other.setCount || setLayouts != other.setLayouts ||
+        pushConstantRanges.size() != other.pushConstantRanges.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < pushConstantRanges.size(); i++) {
+        if (pushConstantRanges[i].stageFlags != other.pushConstantRanges[i].stageFlags ||
+            pushConstantRanges[i].offset != other.pushConstantRanges[i].offset ||
+            pushConstantRanges[i].size != other.pushConstantRanges[i].size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t ShaderEffectRegistry::PipelineLayoutHash::operator()(const PipelineLayoutKey &key) const {
+    vkutil::Hasher64 hasher;
+    hasher.add(key.setCount);
+    for (uint32_t i = 0; i < key.setCount; i++) {
+        hasher.add((uint64_t) key.setLayouts[i]);
+    }
+    for (const VkPushConstantRange &range: key.pushConstantRanges) {
+        hasher.add((uint64_t) range.stageFlags << 32 | range.offset);
+        hasher.add(range.size);
+    }
+    return (size_t) hasher.finish();
+}
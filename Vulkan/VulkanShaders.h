@@ -8,7 +8,9 @@
 #include <vector>
 #include <array>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
+#include <memory>
 
 #include "VulkanDescriptors.h"
 
@@ -22,12 +24,56 @@ namespace vkslime {
     //loads a shader module from a spir-v file. Returns false if it errors
     bool load_shader_module(VkDevice device, const char *filePath, ShaderModule *outShaderModule);
 
-    uint32_t hash_descriptor_layout_info(VkDescriptorSetLayoutCreateInfo *info);
+    //hash of a layout with its bindings sorted by binding number, see vkutil::hash_descriptor_bindings
+    uint64_t hash_descriptor_layout_info(VkDescriptorSetLayoutCreateInfo *info);
 }
 
 
 class VulkanEngine;
 
+//material features compiled into shader variants as specialization constants. A feature's bit index is its
+//constant_id in the shaders, and the driver drops the code behind a false constant when the pipeline is built,
+//so a variant only pays for the features its material uses
+enum ShaderFeatureBits : uint32_t {
+    SHADER_FEATURE_ALPHA_TEST = 1 << 0,
+    SHADER_FEATURE_VERTEX_COLOUR = 1 << 1,
+    SHADER_FEATURE_FOG = 1 << 2,
+};
+using ShaderFeatures = uint32_t;
+constexpr uint32_t SHADER_FEATURE_COUNT = 3;
+
+//specialization constants selecting one variant, a VkBool32 per feature.
+//info points into the struct itself, so it is built in place and not copied
+struct ShaderVariantConstants {
+    explicit ShaderVariantConstants(ShaderFeatures features);
+
+    ShaderVariantConstants(const ShaderVariantConstants &) = delete;
+
+    ShaderVariantConstants &operator=(const ShaderVariantConstants &) = delete;
+
+    std::array<VkSpecializationMapEntry, SHADER_FEATURE_COUNT> entries{};
+    std::array<VkBool32, SHADER_FEATURE_COUNT> values{};
+    VkSpecializationInfo info{};
+};
+
+//everything reflect_layout takes out of the SPIR-V, before any Vulkan objects are made from it.
+//plain data, so it can be stored in the ShaderReflectionCache and rebuilt into an effect on a later run
+struct ShaderReflection {
+    struct Binding {
+        uint32_t set;
+        uint32_t binding;
+        VkDescriptorType type;
+    };
+    std::unordered_map<std::string, Binding> bindings;
+
+    //merged across stages and sorted by binding number
+    std::array<std::vector<VkDescriptorSetLayoutBinding>, 4> setBindings;
+    //hashes of setBindings, 0 for empty sets
+    std::array<uint64_t, 4> setHashes{};
+    uint32_t setCount{0};
+    std::vector<VkPushConstantRange> pushConstantRanges;
+};
+
 //holds all information for a given shader set for pipeline
 struct ShaderEffect {
 
@@ -38,20 +84,44 @@ struct ShaderEffect {
 
     void add_stage(ShaderModule *shaderModule, VkShaderStageFlagBits stage);
 
-    void reflect_layout(VkDevice device, ReflectionOverrides *overrides, int overrideCount);
+    //reflects the stages into set layouts and push constant ranges. Set layouts come from the layout cache, so
+    //equal sets across effects share a handle. A set with an entry in fixedLayouts uses that layout instead,
+    //for sets the engine binds itself. Unused sets below the highest one get an empty layout
+    void reflect_layout(vkutil::DescriptorLayoutCache &layoutCache,
+                        const std::array<VkDescriptorSetLayout, 4> &fixedLayouts,
+                        const ReflectionOverrides *overrides, int overrideCount);
 
-    void fill_stages(std::vector<VkPipelineShaderStageCreateInfo> &pipelineStages);
+    //the two halves of reflect_layout. reflect runs SPIRV-Reflect over the stages, build_layouts turns the
+    //result into set layouts and fills in the members below
+    void reflect(ShaderReflection &outReflection, const ReflectionOverrides *overrides, int overrideCount) const;
 
-    VkPipelineLayout builtLayout;
+    void build_layouts(const ShaderReflection &reflection, vkutil::DescriptorLayoutCache &layoutCache,
+                       const std::array<VkDescriptorSetLayout, 4> &fixedLayouts);
 
-    struct ReflectedBinding {
-        uint32_t set;
-        uint32_t binding;
-        VkDescriptorType type;
-    };
+    //specialization is applied to every stage, constants a stage doesn't declare are ignored by Vulkan
+    void fill_stages(std::vector<VkPipelineShaderStageCreateInfo> &pipelineStages,
+                     const VkSpecializationInfo *specialization = nullptr);
+
+    //hash of the stage code and overrides, the key for the ShaderReflectionCache
+    uint64_t reflection_key(const ReflectionOverrides *overrides, int overrideCount) const;
+
+    bool uses_module(const ShaderModule *shaderModule) const;
+
+    //features some stage declares a specialization constant for, read straight from the SPIR-V so it holds for
+    //effects built from the reflection cache too. Variants of the other features all build the same pipeline
+    ShaderFeatures declared_features() const;
+
+    //owned by the ShaderEffectRegistry, effects with the same sets and push constants share it
+    VkPipelineLayout builtLayout{VK_NULL_HANDLE};
+
+    //sets the pipeline layout has, setLayouts[0..setCount) are all valid
+    uint32_t setCount{0};
+    std::vector<VkPushConstantRange> pushConstantRanges;
+
+    using ReflectedBinding = ShaderReflection::Binding;
     std::unordered_map<std::string, ReflectedBinding> bindings;
-    std::array<VkDescriptorSetLayout, 4> setLayouts;
-    std::array<uint32_t, 4> setHashes;
+    std::array<VkDescriptorSetLayout, 4> setLayouts{};
+    std::array<uint64_t, 4> setHashes{};
 private:
     struct ShaderStage {
         ShaderModule *shaderModule;
@@ -78,8 +148,9 @@ struct ShaderDescriptorBinder {
 
     void apply_binds(VkCommandBuffer cmd);
 
-    //void build_sets(VkDevice device, VkDescriptorPool allocator);
-    void build_sets(VkDevice device, vkutil::DescriptorAllocator &allocator);
+    //fetches a set for every set that has writes from the cache, which only writes a new one when the bound
+    //resources differ from every set it already holds
+    void build_sets(vkutil::DescriptorSetCache &setCache);
 
     void set_shader(ShaderEffect *newShader);
 
@@ -93,6 +164,10 @@ private:
 
     ShaderEffect *shaders{nullptr};
     std::vector<BufferWriteDescriptor> bufferWrites;
+    //set when a write was added, bufferWrites is kept sorted by set and binding
+    bool writesDirty{false};
+    //writes of the set build_sets is fetching, kept to not allocate every frame
+    std::vector<VkWriteDescriptorSet> writeScratch;
 };
 
 class ShaderCache {
@@ -101,7 +176,112 @@ public:
     ShaderModule *get_shader(const std::string &path);
 
     void init(VkDevice device) { _device = device; };
+
+    //loads the file again if the cache holds it, replacing the module in place so pointers to it stay valid.
+    //returns the module if it was reloaded, nullptr if it wasn't cached or the new file failed to load
+    ShaderModule *reload_shader(const std::string &path);
+
+    //destroys every module loaded through the cache
+    void cleanup();
 private:
     VkDevice _device;
     std::unordered_map<std::string, ShaderModule> module_cache;
 };
+
+//reflection results from earlier runs, keyed on a hash of the SPIR-V of every stage and the overrides used.
+//a changed shader hashes differently, so stale entries are never used, they just stop being looked up
+class ShaderReflectionCache {
+public:
+    //reads a cache written by save. A missing, outdated or damaged file leaves the cache empty
+    bool load(const std::string &path);
+
+    //writes the entries found or inserted since the cache was loaded, the rest belong to shaders that changed or
+    //are no longer used and are dropped. Only writes when that differs from what was loaded
+    bool save(const std::string &path);
+
+    //marks the entry as used by this run
+    const ShaderReflection *find(uint64_t key);
+
+    void insert(uint64_t key, const ShaderReflection &reflection);
+
+    size_t get_size() const { return mEntries.size(); }
+
+private:
+    std::unordered_map<uint64_t, ShaderReflection> mEntries;
+    //keys found or inserted since load
+    std::unordered_set<uint64_t> mUsed;
+    bool mDirty{false};
+};
+
+//builds shader effects by reflection and owns what they share. Effects are cached by name, their set layouts
+//are deduplicated through the engine's DescriptorLayoutCache, and effects with the same set layouts and push
+//constant ranges get the same VkPipelineLayout, so switching between their pipelines keeps bound sets valid
+class ShaderEffectRegistry {
+public:
+    struct StageInfo {
+        std::string path;
+        VkShaderStageFlagBits stage;
+    };
+
+    void init(VkDevice device, vkutil::DescriptorLayoutCache *layoutCache);
+
+    //destroys the pipeline layouts and shader modules, the set layouts belong to the layout cache
+    void cleanup();
+
+    //every effect uses this layout for the given set, for sets the engine allocates and binds itself
+    void set_fixed_layout(uint32_t set, VkDescriptorSetLayout layout);
+
+    //returns the effect built from these stages, loading and reflecting them the first time a name is asked for.
+    //returns nullptr if a stage fails to load
+    ShaderEffect *get_effect(const std::string &name, const std::vector<StageInfo> &stages,
+                             const std::vector<ShaderEffect::ReflectionOverrides> &overrides = {});
+
+    //the effect get_effect created under this name, nullptr if there is none
+    ShaderEffect *find_effect(const std::string &name);
+
+    //reloads the given SPIR-V files and rebuilds every effect that uses one of them. Returns the names of the
+    //rebuilt effects, their builtLayout may have changed and pipelines made from them need recreating
+    std::vector<std::string> reload_shaders(const std::vector<std::string> &paths);
+
+    size_t get_pipeline_layout_count() const { return mPipelineLayouts.size(); }
+
+    //effects created after loading skip SPIR-V reflection for shaders reflected on an earlier run
+    bool load_reflection_cache(const std::string &path) { return mReflectionCache.load(path); }
+
+    bool save_reflection_cache(const std::string &path) { return mReflectionCache.save(path); }
+
+private:
+    struct PipelineLayoutKey {
+        std::array<VkDescriptorSetLayout, 4> setLayouts{};
+        uint32_t setCount{0};
+        std::vector<VkPushConstantRange> pushConstantRanges;
+
+        bool operator==(const PipelineLayoutKey &other) const;
+    };
+
+    struct PipelineLayoutHash {
+        size_t operator()(const PipelineLayoutKey &key) const;
+    };
+
+    struct EffectEntry {
+        std::unique_ptr<ShaderEffect> effect;
+        //kept to rebuild the effect on reload
+        std::vector<ShaderEffect::ReflectionOverrides> overrides;
+    };
+
+    //reflects the effect's stages, or takes the reflection from the cache, and builds its layouts from that
+    void build_effect(ShaderEffect &effect, const std::vector<ShaderEffect::ReflectionOverrides> &overrides);
+
+    VkPipelineLayout get_pipeline_layout(const ShaderEffect &effect);
+
+    VkDevice mDevice{VK_NULL_HANDLE};
+    vkutil::DescriptorLayoutCache *mLayoutCache{nullptr};
+    ShaderCache mShaderCache;
+    ShaderReflectionCache mReflectionCache;
+
+    std::array<VkDescriptorSetLayout, 4> mFixedLayouts{};
+
+    //effects are handed out by pointer, so they live on the heap
+    std::unordered_map<std::string, EffectEntry> mEffects;
+    std::unordered_map<PipelineLayoutKey, VkPipelineLayout, PipelineLayoutHash> mPipelineLayouts;
+};
@@ -0,0 +1,484 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#include "VulkanTextureStreaming.h"
+#include "VulkanEngine.h"
+#include "VulkanInitializers.h"
+#include "VulkanTextures.h"
+#include "Log.h"
+
+#include "imgui.h"
+#include "Tracy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+static constexpr uint32_t NO_REQUEST = UINT32_MAX;
+
+void TextureStreamer::init(VulkanEngine *engine, const TextureStreamingConfig &config) {
+    mEngine = engine;
+    mConfig = config;
+    update_budget();
+}
+
+void TextureStreamer::cleanup() {
+    for (StreamedTexture &texture: mTextures) {
+        if (texture.image.mImage != VK_NULL_HANDLE) {
+            vkDestroyImageView(mEngine->mDevice, texture.image.mDefaultView, nullptr);
+            vmaDestroyImage(mEngine->mAllocator, texture.image.mImage, texture.image.mAllocation);
+            texture.image = {};
+        }
+    }
+    mTextures.clear();
+    mResidentBytes = 0;
+}
+
+StreamedTextureId TextureStreamer::add_texture(const std::string &path) {
+    ZoneScopedN("Add Streamed Texture")
+
+    StreamedTexture texture;
+    texture.path = path;
+
+    if (!assets::load_binaryfile(path.c_str(), texture.file)) {
+        Log::error("Failed to load streamed texture " + path);
+        return INVALID_STREAMED_TEXTURE;
+    }
+
+    texture.info = assets::read_texture_info(&texture.file);
+    texture.format = vkutil::get_image_format(texture.info);
+    if (texture.format == VK_FORMAT_UNDEFINED || texture.info.pages.empty()) {
+        Log::error("Unsupported streamed texture " + path);
+        return INVALID_STREAMED_TEXTURE;
+    }
+
+    //the tail starts at the first mip that fits in tailSize, textures without mips are all tail
+    auto mipCount = (uint32_t) texture.info.pages.size();
+    texture.tailMip = mipCount - 1;
+    for (uint32_t mip = 0; mip < mipCount; mip++) {
+        const assets::PageInfo &page = texture.info.pages[mip];
+        if (std::max(page.width, page.height) <= mConfig.tailSize) {
+            texture.tailMip = mip;
+            break;
+        }
+    }
+    if (mipCount == 1) {
+        Log::warn("Streamed texture " + path + " has no mips, it is always fully resident");
+    }
+
+    auto id = (StreamedTextureId) mTextures.size();
+    mTextures.push_back(std::move(texture));
+
+    //the tail goes up straight away so the texture can be drawn from the first frame
+    StreamedTexture &added = mTextures.back();
+    bool uploaded = false;
+    mEngine->immediate_submit([&](VkCommandBuffer cmd) {
+        uploaded = set_resident_mip(added, added.tailMip, cmd);
+    });
+    if (!uploaded) {
+        mTextures.pop_back();
+        return INVALID_STREAMED_TEXTURE;
+    }
+    added.targetMip = added.tailMip;
+
+    return id;
+}
+
+void TextureStreamer::request(StreamedTextureId id, float screenPixels) {
+    if (id == INVALID_STREAMED_TEXTURE) {
+        return;
+    }
+
+    StreamedTexture &texture = mTextures[id];
+    const assets::PageInfo &top = texture.info.pages[0];
+
+    //one texel per pixel: every halving of the on-screen size drops one mip
+    uint32_t mip = 0;
+    if (std::isfinite(screenPixels)) {
+        float texels = (float) std::max(top.width, top.height);
+        float level = std::log2(texels / std::max(screenPixels, 1.0f)) + mConfig.mipBias;
+        mip = (uint32_t) std::clamp(level, 0.0f, (float) texture.tailMip);
+    }
+
+    texture.requestedMip = std::min(texture.requestedMip, mip);
+}
+
+void TextureStreamer::update(VkCommandBuffer cmd, int frameNumber, uint32_t freeBindlessSlots) {
+    ZoneScopedN("Texture Streaming")
+
+    update_budget();
+    mUploadedThisFrame = 0;
+    mFreeBindlessSlots = freeBindlessSlots;
+    mUpgradesLastFrame = 0;
+    mEvictionsLastFrame = 0;
+
+    //turn the requests of the last frame into targets
+    for (StreamedTexture &texture: mTextures) {
+        if (texture.requestedMip != NO_REQUEST) {
+            texture.targetMip = texture.requestedMip;
+            texture.lastRequestFrame = frameNumber;
+        } else if (texture.lastRequestFrame < 0 ||
+                   frameNumber - texture.lastRequestFrame > (int) mConfig.demandTimeoutFrames) {
+            //not drawn for a while, its detail is only kept while nobody else needs the memory
+            texture.targetMip = texture.tailMip;
+        }
+        texture.requestedMip = NO_REQUEST;
+    }
+
+    //the budget can shrink under us when other allocations grow, shed what nobody is asking for first
+    if (mResidentBytes > mBudgetBytes) {
+        make_room(0, nullptr, cmd);
+    }
+    //still over, so visible textures give up detail too, starting with the ones that wanted the least
+    while (mResidentBytes > mBudgetBytes) {
+        StreamedTexture *victim = nullptr;
+        for (StreamedTexture &texture: mTextures) {
+            if (texture.residentMip < texture.tailMip &&
+                (victim == nullptr || texture.targetMip > victim->targetMip)) {
+                victim = &texture;
+            }
+        }
+        if (victim == nullptr || !set_resident_mip(*victim, victim->residentMip + 1, cmd)) {
+            break;
+        }
+        victim->targetMip = victim->residentMip;
+        mEvictionsLastFrame++;
+    }
+
+    //biggest gap between what is resident and what is wanted goes first
+    std::vector<StreamedTexture *> upgrades;
+    for (StreamedTexture &texture: mTextures) {
+        if (texture.targetMip < texture.residentMip) {
+            upgrades.push_back(&texture);
+        }
+    }
+    std::sort(upgrades.begin(), upgrades.end(), [](const StreamedTexture *a, const StreamedTexture *b) {
+        return a->residentMip - a->targetMip > b->residentMip - b->targetMip;
+    });
+
+    for (StreamedTexture *texture: upgrades) {
+        //as much detail as this frame's upload allowance takes. The first upgrade of a frame always gets at
+        //least one mip, otherwise a texture bigger than the allowance would never stream in
+        uint32_t mip = texture->targetMip;
+        while (mip < texture->residentMip &&
+               mUploadedThisFrame + mip_range_bytes(*texture, mip) > mConfig.maxUploadBytesPerFrame) {
+            mip++;
+        }
+        if (mip == texture->residentMip) {
+            if (mUploadedThisFrame > 0) {
+                break;
+            }
+            mip = texture->residentMip - 1;
+        }
+
+        //then as much as fits in VRAM, evicting unused detail if that helps
+        //resident bytes are allocation sizes, which can be padded past the raw size of the smaller range
+        uint64_t newBytes = mip_range_bytes(*texture, mip);
+        uint64_t extra = newBytes > texture->residentBytes ? newBytes - texture->residentBytes : 0;
+        if (mResidentBytes + extra > mBudgetBytes && !make_room(extra, texture, cmd)) {
+            while (mip < texture->residentMip &&
+                   mResidentBytes - texture->residentBytes + mip_range_bytes(*texture, mip) > mBudgetBytes) {
+                mip++;
+            }
+            if (mip == texture->residentMip) {
+                continue;
+            }
+        }
+
+        if (set_resident_mip(*texture, mip, cmd)) {
+            mUpgradesLastFrame++;
+        }
+    }
+
+    TracyPlot("Streamed Texture MB", (double) mResidentBytes / (1024.0 * 1024.0));
+}
+
+uint64_t TextureStreamer::mip_range_bytes(const StreamedTexture &texture, uint32_t firstMip) const {
+    uint64_t bytes = 0;
+    for (size_t mip = firstMip; mip < texture.info.pages.size(); mip++) {
+        bytes += texture.info.pages[mip].originalSize;
+    }
+    return bytes;
+}
+
+bool TextureStreamer::set_resident_mip(StreamedTexture &texture, uint32_t firstMip, VkCommandBuffer cmd) {
+    ZoneScopedNC("Stream Texture Mips", tracy::Color::Yellow)
+
+    //a material that can't move to a new slot keeps sampling the old image after it is destroyed, so the
+    //residency change waits until released slots come back
+    bool replacing = texture.image.mImage != VK_NULL_HANDLE;
+    if (replacing && texture.slotUsers > mFreeBindlessSlots) {
+        return false;
+    }
+
+    auto mipCount = (uint32_t) texture.info.pages.size() - firstMip;
+    uint64_t bytes = mip_range_bytes(texture, firstMip);
+
+    const assets::PageInfo &top = texture.info.pages[firstMip];
+    VkExtent3D imageExtent;
+    imageExtent.width = top.width;
+    imageExtent.height = top.height;
+    imageExtent.depth = 1;
+
+    //transfer source so a later eviction can copy the mips it keeps out of this image
+    VkImageCreateInfo imageInfo = vkslime::image_create_info(texture.format, VK_IMAGE_USAGE_SAMPLED_BIT |
+                                                                             VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                                                                             VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                                             imageExtent);
+    imageInfo.mipLevels = mipCount;
+
+    VmaAllocationCreateInfo imageAllocInfo = {};
+    imageAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    AllocatedImage newImage{};
+    VmaAllocationInfo allocationInfo{};
+    VkResult result = vmaCreateImage(mEngine->mAllocator, &imageInfo, &imageAllocInfo, &newImage.mImage,
+                                     &newImage.mAllocation, &allocationInfo);
+    if (result != VK_SUCCESS) {
+        Log::warn("Out of memory streaming " + texture.path + ", keeping mip " +
+                  std::to_string(texture.residentMip));
+        return false;
+    }
+    newImage.mMipLevels = (int) mipCount;
+
+    //dropping detail keeps a tail of what is already in VRAM, so it is copied over on the GPU instead of going
+    //through the staging buffer and the upload allowance
+    bool evicting = replacing && firstMip > texture.residentMip;
+    if (evicting) {
+        copy_resident_mips(texture, newImage, firstMip, cmd);
+    } else {
+        upload_mips(texture, newImage, firstMip, cmd);
+        mUploadedThisFrame += bytes;
+    }
+
+    VkImageViewCreateInfo viewInfo = vkslime::imageview_create_info(texture.format, newImage.mImage,
+                                                                    VK_IMAGE_ASPECT_COLOR_BIT);
+    viewInfo.subresourceRange.levelCount = mipCount;
+    VK_CHECK_RESULT(vkCreateImageView(mEngine->mDevice, &viewInfo, nullptr, &newImage.mDefaultView));
+
+    //frames still in flight may sample the old image, it goes once this frame has retired. The frame being
+    //recorded samples the new one, its users move to the slots reserved above
+    if (replacing) {
+        mEngine->destroy_image(texture.image);
+        mResidentBytes -= texture.residentBytes;
+        mFreeBindlessSlots -= texture.slotUsers;
+    }
+
+    texture.image = newImage;
+    texture.residentMip = firstMip;
+    texture.residentBytes = allocationInfo.size;
+    texture.version++;
+
+    mResidentBytes += texture.residentBytes;
+    return true;
+}
+
+void TextureStreamer::upload_mips(StreamedTexture &texture, const AllocatedImage &image, uint32_t firstMip,
+                                  VkCommandBuffer cmd) {
+    auto mipCount = (uint32_t) texture.info.pages.size() - firstMip;
+    uint64_t bytes = mip_range_bytes(texture, firstMip);
+
+    //unpack the pages straight into the staging buffer, largest mip first like the image levels
+    AllocatedBufferUntyped stagingBuffer = mEngine->create_buffer(bytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                                  VMA_MEMORY_USAGE_CPU_ONLY);
+    std::vector<VkBufferImageCopy> copies(mipCount);
+    {
+        ZoneScopedNC("Unpack Texture", tracy::Color::Magenta)
+
+        char *data;
+        vmaMapMemory(mEngine->mAllocator, stagingBuffer.mAllocation, (void **) &data);
+
+        size_t offset = 0;
+        for (uint32_t level = 0; level < mipCount; level++) {
+            const assets::PageInfo &page = texture.info.pages[firstMip + level];
+            assets::unpack_texture_page(&texture.info, (int) (firstMip + level), texture.file.binaryBlob.data(),
+                                        data + offset);
+
+            VkBufferImageCopy &copy = copies[level];
+            copy = {};
+            copy.bufferOffset = offset;
+            copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            copy.imageSubresource.mipLevel = level;
+            copy.imageSubresource.baseArrayLayer = 0;
+            copy.imageSubresource.layerCount = 1;
+            copy.imageExtent = {page.width, page.height, 1};
+
+            offset += page.originalSize;
+        }
+
+        vmaUnmapMemory(mEngine->mAllocator, stagingBuffer.mAllocation);
+    }
+
+    VkImageMemoryBarrier toTransfer = {};
+    toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.image = image.mImage;
+    toTransfer.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipCount, 0, 1};
+    toTransfer.srcAccessMask = 0;
+    toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &toTransfer);
+
+    vkCmdCopyBufferToImage(cmd, stagingBuffer.mBuffer, image.mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           mipCount, copies.data());
+
+    VkImageMemoryBarrier toReadable = toTransfer;
+    toReadable.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toReadable.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    toReadable.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toReadable.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr,
+                         0, nullptr, 1, &toReadable);
+
+    mEngine->destroy_buffer(stagingBuffer);
+}
+
+void TextureStreamer::copy_resident_mips(const StreamedTexture &texture, const AllocatedImage &image,
+                                         uint32_t firstMip, VkCommandBuffer cmd) {
+    auto mipCount = (uint32_t) texture.info.pages.size() - firstMip;
+    uint32_t sourceMip = firstMip - texture.residentMip;
+
+    //the old image is only read from here on. The frames that sampled it were submitted before this one, and an
+    //earlier eviction this frame may have just written it, so wait on both before changing its layout
+    VkImageMemoryBarrier barriers[2] = {};
+    VkImageMemoryBarrier &sourceToTransfer = barriers[0];
+    sourceToTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    sourceToTransfer.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    sourceToTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    sourceToTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    sourceToTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    sourceToTransfer.image = texture.image.mImage;
+    sourceToTransfer.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, sourceMip, mipCount, 0, 1};
+    sourceToTransfer.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    sourceToTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    VkImageMemoryBarrier &destinationToTransfer = barriers[1];
+    destinationToTransfer = sourceToTransfer;
+    destinationToTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    destinationToTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    destinationToTransfer.image = image.mImage;
+    destinationToTransfer.subresourceRange.baseMipLevel = 0;
+    destinationToTransfer.srcAccessMask = 0;
+    destinationToTransfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, barriers);
+
+    std::vector<VkImageCopy> copies(mipCount);
+    for (uint32_t level = 0; level < mipCount; level++) {
+        const assets::PageInfo &page = texture.info.pages[firstMip + level];
+
+        VkImageCopy &copy = copies[level];
+        copy = {};
+        copy.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, sourceMip + level, 0, 1};
+        copy.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+        copy.extent = {page.width, page.height, 1};
+    }
+
+    vkCmdCopyImage(cmd, texture.image.mImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image.mImage,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipCount, copies.data());
+
+    VkImageMemoryBarrier toReadable = destinationToTransfer;
+    toReadable.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toReadable.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    toReadable.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toReadable.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr,
+                         0, nullptr, 1, &toReadable);
+}
+
+bool TextureStreamer::make_room(uint64_t neededBytes, const StreamedTexture *keep, VkCommandBuffer cmd) {
+    //textures holding more detail than they are asked for, least recently drawn first
+    std::vector<StreamedTexture *> candidates;
+    for (StreamedTexture &texture: mTextures) {
+        if (&texture != keep && texture.residentMip < texture.targetMip) {
+            candidates.push_back(&texture);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const StreamedTexture *a, const StreamedTexture *b) {
+        return a->lastRequestFrame < b->lastRequestFrame;
+    });
+
+    for (StreamedTexture *texture: candidates) {
+        if (mResidentBytes + neededBytes <= mBudgetBytes) {
+            break;
+        }
+        if (set_resident_mip(*texture, texture->targetMip, cmd)) {
+            mEvictionsLastFrame++;
+        }
+    }
+
+    return mResidentBytes + neededBytes <= mBudgetBytes;
+}
+
+void TextureStreamer::update_budget() {
+    const VkPhysicalDeviceMemoryProperties *memoryProperties;
+    vmaGetMemoryProperties(mEngine->mAllocator, &memoryProperties);
+
+    VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+    vmaGetHeapBudgets(mEngine->mAllocator, budgets);
+
+    //the largest device local heap is where images end up
+    uint64_t heapBudget = 0;
+    uint64_t heapUsage = 0;
+    for (uint32_t heap = 0; heap < memoryProperties->memoryHeapCount; heap++) {
+        if ((memoryProperties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) &&
+            budgets[heap].budget > heapBudget) {
+            heapBudget = budgets[heap].budget;
+            heapUsage = budgets[heap].usage;
+        }
+    }
+
+    uint64_t budget = (uint64_t) ((double) heapBudget * mConfig.heapBudgetFraction);
+    if (mConfig.budgetBytes != 0) {
+        budget = std::min(budget, mConfig.budgetBytes);
+    }
+
+    //whatever else lives in the heap counts too, never plan past what VMA says is left
+    uint64_t heapFree = heapBudget > heapUsage ? heapBudget - heapUsage : 0;
+    mBudgetBytes = std::min(budget, mResidentBytes + heapFree);
+}
+
+void TextureStreamer::draw_imgui() {
+    ImGui::Begin("Texture Streaming");
+
+    const double megabyte = 1024.0 * 1024.0;
+    float usage = mBudgetBytes > 0 ? (float) ((double) mResidentBytes / (double) mBudgetBytes) : 0.0f;
+    std::string overlay = std::to_string((int) ((double) mResidentBytes / megabyte)) + " / " +
+                          std::to_string((int) ((double) mBudgetBytes / megabyte)) + " MB";
+    ImGui::ProgressBar(usage, ImVec2(-1.0f, 0.0f), overlay.c_str());
+    ImGui::Text("Upgrades %u  Evictions %u  Uploaded %.2f MB", mUpgradesLastFrame, mEvictionsLastFrame,
+                (double) mUploadedThisFrame / megabyte);
+
+    if (ImGui::BeginTable("Streamed Textures", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+        ImGui::TableSetupColumn("Texture");
+        ImGui::TableSetupColumn("Resident");
+        ImGui::TableSetupColumn("Target");
+        ImGui::TableSetupColumn("MB");
+        ImGui::TableHeadersRow();
+
+        for (const StreamedTexture &texture: mTextures) {
+            const assets::PageInfo &resident = texture.info.pages[texture.residentMip];
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(std::filesystem::path(texture.path).filename().string().c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("mip %u (%ux%u)", texture.residentMip, resident.width, resident.height);
+            ImGui::TableNextColumn();
+            ImGui::Text("mip %u", texture.targetMip);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", (double) texture.residentBytes / megabyte);
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
@@ -0,0 +1,135 @@
+//
+// Created by alexm on 18/10/2026.
+//
+
+#pragma once
+
+#include "VulkanTypes.h"
+
+#include "asset_loader.h"
+#include "texture_asset.h"
+
+#include <string>
+#include <vector>
+
+class VulkanEngine;
+
+using StreamedTextureId = uint32_t;
+constexpr StreamedTextureId INVALID_STREAMED_TEXTURE = UINT32_MAX;
+
+struct TextureStreamingConfig {
+    //VRAM the streamed textures may use. 0 picks heapBudgetFraction of the device local heap budget
+    uint64_t budgetBytes{0};
+    //share of the VMA device local budget the streamer allows itself, also caps budgetBytes
+    float heapBudgetFraction{0.5f};
+
+    //mips this size and smaller are uploaded when the texture is added and never evicted
+    uint32_t tailSize{64};
+
+    //bytes uploaded per frame at most, so a camera cut doesn't turn into a frame hitch
+    uint64_t maxUploadBytesPerFrame{16 * 1024 * 1024};
+
+    //added to the demanded mip, negative values ask for sharper textures
+    float mipBias{0.0f};
+
+    //frames without a request before a texture's demand falls back to its tail
+    uint32_t demandTimeoutFrames{120};
+};
+
+//keeps texture assets in memory and only the mips the camera needs in VRAM.
+//a texture starts with its low resolution tail, objects on screen request detail, and update() once per frame
+//raises or lowers residency within the budget. Changing residency rebuilds the image with the new mip range,
+//uploading from the in-memory pages when adding detail and copying the kept mips on the GPU when dropping it.
+//the old image is retired through the engine's deferred deletion
+class TextureStreamer {
+public:
+    void init(VulkanEngine *engine, const TextureStreamingConfig &config);
+
+    //destroys the images still resident, the device has to be idle
+    void cleanup();
+
+    //loads a baked texture asset and uploads its mip tail. Returns INVALID_STREAMED_TEXTURE on failure
+    StreamedTextureId add_texture(const std::string &path);
+
+    //screen-space demand: an object using the texture covers screenPixels along its largest axis.
+    //infinite means the camera is inside the object and wants full detail
+    void request(StreamedTextureId id, float screenPixels);
+
+    //applies the requests made since the last update, recording uploads into cmd outside of a render pass.
+    //replacing an image moves every material sampling it to a new bindless slot, so only textures whose users
+    //fit in freeBindlessSlots change residency this frame
+    void update(VkCommandBuffer cmd, int frameNumber, uint32_t freeBindlessSlots);
+
+    //a material samples the texture through a bindless slot of its own
+    void add_slot_user(StreamedTextureId id) { mTextures[id].slotUsers++; }
+
+    VkImageView get_view(StreamedTextureId id) const { return mTextures[id].image.mDefaultView; }
+
+    //bumped whenever the texture's image is replaced, descriptor sets rewrite when it changes
+    uint32_t get_version(StreamedTextureId id) const { return mTextures[id].version; }
+
+    uint64_t get_resident_bytes() const { return mResidentBytes; }
+
+    uint64_t get_budget_bytes() const { return mBudgetBytes; }
+
+    void draw_imgui();
+
+private:
+    struct StreamedTexture {
+        std::string path;
+        assets::AssetFile file;
+        assets::TextureInfo info;
+        VkFormat format{VK_FORMAT_UNDEFINED};
+
+        //first mip of the tail that always stays resident
+        uint32_t tailMip{0};
+        //most detailed mip on the GPU, the image holds residentMip..last
+        uint32_t residentMip{0};
+        //most detailed mip asked for since the last update, UINT32_MAX if nothing drew it
+        uint32_t requestedMip{UINT32_MAX};
+        int lastRequestFrame{-1};
+        //what update() is working towards, anything more detailed than this can be evicted
+        uint32_t targetMip{0};
+
+        AllocatedImage image;
+        uint64_t residentBytes{0};
+        uint32_t version{0};
+
+        //materials that need a new bindless slot when the image is replaced
+        uint32_t slotUsers{0};
+    };
+
+    //bytes of mips first..last of the texture
+    uint64_t mip_range_bytes(const StreamedTexture &texture, uint32_t firstMip) const;
+
+    //rebuilds the texture's image to hold firstMip..last. Only uploads count against maxUploadBytesPerFrame.
+    //returns false and keeps the old image if the new one could not be allocated or its users have no free slots
+    bool set_resident_mip(StreamedTexture &texture, uint32_t firstMip, VkCommandBuffer cmd);
+
+    //unpacks firstMip..last from the asset pages and copies them into image through a staging buffer
+    void upload_mips(StreamedTexture &texture, const AllocatedImage &image, uint32_t firstMip, VkCommandBuffer cmd);
+
+    //copies firstMip..last out of the texture's current image, which has to hold them already
+    void copy_resident_mips(const StreamedTexture &texture, const AllocatedImage &image, uint32_t firstMip,
+                            VkCommandBuffer cmd);
+
+    //drops detail from textures nobody asked for, least recently requested first, until needed bytes fit
+    bool make_room(uint64_t neededBytes, const StreamedTexture *keep, VkCommandBuffer cmd);
+
+    void update_budget();
+
+    VulkanEngine *mEngine{nullptr};
+    TextureStreamingConfig mConfig;
+
+    std::vector<StreamedTexture> mTextures;
+
+    uint64_t mResidentBytes{0};
+    uint64_t mBudgetBytes{0};
+    uint64_t mUploadedThisFrame{0};
+    //bindless slots not yet taken by textures replaced this frame
+    uint32_t mFreeBindlessSlots{0};
+
+    //totals over the last update, for the panel
+    uint32_t mUpgradesLastFrame{0};
+    uint32_t mEvictionsLastFrame{0};
+};
@@ -4,6 +4,7 @@
 
 #include "VulkanTextures.h"
 #include <iostream>
+#include <algorithm>
 
 #include "VulkanInitializers.h"
 #include "Tracy.hpp"
@@ -17,10 +18,35 @@
 
 #include "Log.h"
 
+VkFormat vkutil::get_image_format(const assets::TextureInfo &info) {
+    //block compressed pages are uploaded as-is, the GPU decodes them when sampling
+    switch (info.textureFormat) {
+        case assets::TextureFormat::RGBA8:
+            return info.srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+        case assets::TextureFormat::BC1:
+            return info.srgb ? VK_FORMAT_BC1_RGBA_SRGB_BLOCK : VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case assets::TextureFormat::BC3:
+            return info.srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+        case assets::TextureFormat::BC5:
+            //two channel data is never colour, there is no sRGB BC5
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case assets::TextureFormat::BC7:
+            return info.srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+        default:
+            return VK_FORMAT_UNDEFINED;
+    }
+}
+
 bool vkutil::load_image_from_file(VulkanEngine &engine, const char *file, AllocatedImage &outImage) {
+    ZoneScopedN("Load Image File")
+
     int texWidth, texHeight, texChannels;
 
-    stbi_uc *pixels = stbi_load(file, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    stbi_uc *pixels;
+    {
+        ZoneScopedNC("Decode Image", tracy::Color::Magenta)
+        pixels = stbi_load(file, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    }
 
     if (!pixels) {
         Log::error("Failed to load texture file " + std::string(file));
@@ -58,8 +84,14 @@ bool vkutil::load_image_from_file(VulkanEngine &engine, const char *file, Alloca
 
 
 bool vkutil::load_image_from_asset(VulkanEngine &engine, const char *filename, AllocatedImage &outImage) {
+    ZoneScopedN("Load Image Asset")
+
     assets::AssetFile file;
-    bool loaded = assets::load_binaryfile(filename, file);
+    bool loaded;
+    {
+        ZoneScopedN("Read Asset File")
+        loaded = assets::load_binaryfile(filename, file);
+    }
 
     if (!loaded) {
         std::cout << "Error when loading texture " << filename << std::endl;
@@ -70,13 +102,10 @@ bool vkutil::load_image_from_asset(VulkanEngine &engine, const char *filename, A
 
 
     VkDeviceSize imageSize = textureInfo.textureSize;
-    VkFormat image_format;
-    switch (textureInfo.textureFormat) {
-        case assets::TextureFormat::RGBA8:
-            image_format = VK_FORMAT_R8G8B8A8_SRGB;
-            break;
-        default:
-            return false;
+    VkFormat image_format = get_image_format(textureInfo);
+    if (image_format == VK_FORMAT_UNDEFINED) {
+        Log::error("Unsupported texture format in " + std::string(filename));
+        return false;
     }
 
     AllocatedBufferUntyped stagingBuffer = engine.create_buffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
@@ -114,6 +143,8 @@ bool vkutil::load_image_from_asset(VulkanEngine &engine, const char *filename, A
 
 AllocatedImage vkutil::upload_image(int texWidth, int texHeight, VkFormat image_format, VulkanEngine &engine,
                                     AllocatedBufferUntyped &stagingBuffer) {
+    ZoneScopedNC("Upload Image", tracy::Color::Yellow)
+
     VkExtent3D imageExtent;
     imageExtent.width = static_cast<uint32_t>(texWidth);
     imageExtent.height = static_cast<uint32_t>(texHeight);
@@ -191,10 +222,7 @@ AllocatedImage vkutil::upload_image(int texWidth, int texHeight, VkFormat image_
     vkCreateImageView(engine.mDevice, &view_info, nullptr, &newImage.mDefaultView);
 
 
-    engine.mMainDeletionQueue.push_function([=, &engine]() {
-
-        vmaDestroyImage(engine.mAllocator, newImage.mImage, newImage.mAllocation);
-    });
+    engine.mMainDeletionQueue.push_image(newImage);
 
 
     newImage.mMipLevels = 1;// mips.size();
@@ -203,6 +231,8 @@ AllocatedImage vkutil::upload_image(int texWidth, int texHeight, VkFormat image_
 
 AllocatedImage vkutil::upload_image_mipmapped(int texWidth, int texHeight, VkFormat image_format, VulkanEngine &engine,
                                               AllocatedBufferUntyped &stagingBuffer, std::vector<MipmapInfo> mips) {
+    ZoneScopedNC("Upload Image", tracy::Color::Yellow)
+
     VkExtent3D imageExtent;
     imageExtent.width = static_cast<uint32_t>(texWidth);
     imageExtent.height = static_cast<uint32_t>(texHeight);
@@ -264,8 +294,9 @@ AllocatedImage vkutil::upload_image_mipmapped(int texWidth, int texHeight, VkFor
             vkCmdCopyBufferToImage(cmd, stagingBuffer.mBuffer, newImage.mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
                                    &copyRegion);
 
-            imageExtent.width /= 2;
-            imageExtent.height /= 2;
+            //non square textures keep going on the short side at 1 texel
+            imageExtent.width = std::max(1u, imageExtent.width / 2);
+            imageExtent.height = std::max(1u, imageExtent.height / 2);
         }
         VkImageMemoryBarrier imageBarrier_toReadable = imageBarrier_toTransfer;
 
@@ -290,10 +321,7 @@ AllocatedImage vkutil::upload_image_mipmapped(int texWidth, int texHeight, VkFor
     view_info.subresourceRange.levelCount = newImage.mMipLevels;
     vkCreateImageView(engine.mDevice, &view_info, nullptr, &newImage.mDefaultView);
 
-    engine.mMainDeletionQueue.push_function([=, &engine]() {
-
-        vmaDestroyImage(engine.mAllocator, newImage.mImage, newImage.mAllocation);
-    });
+    engine.mMainDeletionQueue.push_image(newImage);
 
     return newImage;
 }
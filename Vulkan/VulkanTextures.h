@@ -6,6 +6,7 @@
 
 #include "VulkanTypes.h"
 #include "VulkanEngine.h"
+#include "texture_asset.h"
 
 namespace vkutil {
 
@@ -14,6 +15,9 @@ namespace vkutil {
         size_t dataOffset;
     };
 
+    //VkFormat matching a texture asset's format and colour space, VK_FORMAT_UNDEFINED if there is none
+    VkFormat get_image_format(const assets::TextureInfo &info);
+
     bool load_image_from_file(VulkanEngine &engine, const char *file, AllocatedImage &outImage);
 
     bool load_image_from_asset(VulkanEngine &engine, const char *file, AllocatedImage &outImage);
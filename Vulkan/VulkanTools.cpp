@@ -20,6 +20,19 @@ namespace vkslime::tools {
     }
 
 
+    std::string presentModeString(VkPresentModeKHR presentMode) {
+        switch (presentMode) {
+#define STR(r) case VK_PRESENT_MODE_ ##r: return #r
+            STR(IMMEDIATE_KHR);
+            STR(MAILBOX_KHR);
+            STR(FIFO_KHR);
+            STR(FIFO_RELAXED_KHR);
+#undef STR
+            default:
+                return "UNKNOWN_PRESENT_MODE";
+        }
+    }
+
     bool fileExists(const std::string &filename) {
         std::ifstream f(filename.c_str());
         return !f.fail();
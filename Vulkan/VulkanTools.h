@@ -21,6 +21,8 @@ namespace vkslime::tools {
 
     std::string physicalDeviceTypeString(VkPhysicalDeviceType type);
 
+    std::string presentModeString(VkPresentModeKHR presentMode);
+
     bool fileExists(const std::string &filename);
 
     uint32_t alignedSize(uint32_t value, uint32_t alignment);
@@ -33,10 +33,10 @@ struct AllocatedBuffer : public AllocatedBufferUntyped {
 };
 
 struct AllocatedImage {
-    VkImage mImage;
-    VmaAllocation mAllocation;
-    VkImageView mDefaultView;
-    int mMipLevels;
+    VkImage mImage{VK_NULL_HANDLE};
+    VmaAllocation mAllocation{VK_NULL_HANDLE};
+    VkImageView mDefaultView{VK_NULL_HANDLE};
+    int mMipLevels{1};
 };
 
 
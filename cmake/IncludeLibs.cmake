@@ -35,11 +35,16 @@ include_directories(${spirv_ref_SOURCE_DIR})
 
 #include Tracy
 include_directories(${tracy_SOURCE_DIR})
+#set on assetlib so the zones in assetlib, slime_core and everything linking them are compiled in
+if (TRACY_ENABLE)
+    target_compile_definitions(assetlib PUBLIC TRACY_ENABLE)
+    target_link_libraries(assetlib PUBLIC TracyClient)
+endif ()
 
 #include lz4
 message(${lz4_SOURCE_DIR}/lib)
 include_directories(${lz4_SOURCE_DIR}/lib)
-target_link_libraries(VulkanSlime lz4_static)
+target_link_libraries(assetlib PUBLIC lz4_static)
 
 #Compiling and Linking ImGui
 target_sources(VulkanSlime PRIVATE
@@ -0,0 +1,64 @@
+# targets the optimization switches apply to
+set(VKSLIME_OPTIMIZED_TARGETS VulkanSlime assetlib slime_core)
+if (TARGET slime_bench)
+    list(APPEND VKSLIME_OPTIMIZED_TARGETS slime_bench)
+endif ()
+if (TARGET slime_baker)
+    list(APPEND VKSLIME_OPTIMIZED_TARGETS slime_baker)
+endif ()
+if (TARGET slime_tests)
+    list(APPEND VKSLIME_OPTIMIZED_TARGETS slime_tests)
+endif ()
+
+# ----------------------------------------------------------
+# Link time optimization
+option(VKSLIME_LTO "Build with link time optimization" OFF)
+
+if (VKSLIME_LTO)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT ipoSupported OUTPUT ipoError)
+    if (ipoSupported)
+        message("LTO enabled")
+        set_property(TARGET ${VKSLIME_OPTIMIZED_TARGETS} PROPERTY INTERPROCEDURAL_OPTIMIZATION TRUE)
+    else ()
+        message(WARNING "LTO is not supported by this compiler: ${ipoError}")
+    endif ()
+endif ()
+
+# ----------------------------------------------------------
+# Profile guided optimization
+# 1. configure with -DVKSLIME_PGO=GENERATE and build, this gives an instrumented binary
+# 2. run the benchmark scene as the training run, profiles are written to VKSLIME_PGO_DIR
+# 3. (clang only) merge the raw profiles: llvm-profdata merge -output=<dir>/default.profdata <dir>/*.profraw
+# 4. reconfigure with -DVKSLIME_PGO=USE and rebuild
+set(VKSLIME_PGO "OFF" CACHE STRING "Profile guided optimization stage")
+set_property(CACHE VKSLIME_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(VKSLIME_PGO_DIR "${CMAKE_BINARY_DIR}/pgo" CACHE PATH "Where PGO profiles are written and read")
+
+if (NOT VKSLIME_PGO STREQUAL "OFF")
+    if (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        if (VKSLIME_PGO STREQUAL "GENERATE")
+            set(pgoFlags -fprofile-generate=${VKSLIME_PGO_DIR} -fprofile-update=atomic)
+        else ()
+            #profiles from a slightly different build are still useful, so don't treat mismatches as errors
+            set(pgoFlags -fprofile-use=${VKSLIME_PGO_DIR} -fprofile-correction -Wno-missing-profile)
+        endif ()
+    elseif (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        if (VKSLIME_PGO STREQUAL "GENERATE")
+            set(pgoFlags -fprofile-instr-generate=${VKSLIME_PGO_DIR}/slime-%p.profraw)
+        else ()
+            set(pgoFlags -fprofile-instr-use=${VKSLIME_PGO_DIR}/default.profdata -Wno-profile-instr-unprofiled)
+        endif ()
+    else ()
+        message(WARNING "VKSLIME_PGO is only supported with GCC and Clang")
+    endif ()
+
+    if (pgoFlags)
+        message("PGO stage ${VKSLIME_PGO}, profiles in ${VKSLIME_PGO_DIR}")
+        file(MAKE_DIRECTORY ${VKSLIME_PGO_DIR})
+        foreach (target ${VKSLIME_OPTIMIZED_TARGETS})
+            target_compile_options(${target} PRIVATE ${pgoFlags})
+            target_link_options(${target} PRIVATE ${pgoFlags})
+        endforeach ()
+    endif ()
+endif ()